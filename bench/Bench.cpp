@@ -0,0 +1,92 @@
+/** \file Bench.cpp
+ *
+ *  \brief Implements the shared benchmark bits.
+ *
+ */
+
+#include "Bench.hpp"
+#include "projectinfo.hpp"
+
+#include <cstdio>
+
+namespace Bench {
+    namespace {
+        /** \brief Writes a string as a JSON string literal.
+         */
+        void jsonString(std::FILE * out, const std::string & str) {
+            std::fputc('"', out);
+
+            for (unsigned char c : str) {
+                if (c == '"' || c == '\\') {
+                    std::fprintf(out, "\\%c", c);
+                } else if (c < 0x20) {
+                    std::fprintf(out, "\\u%04X", c);
+                } else {
+                    std::fputc(c, out);
+                }
+            }
+
+            std::fputc('"', out);
+        }
+    }
+
+    double Result::mbps() const {
+        return bytes * iterations / seconds / 1e6;
+    }
+
+    double Result::usPerIter() const {
+        return seconds / iterations * 1e6;
+    }
+
+    double Result::allocsPerIter() const {
+        return static_cast<double>(allocs) / iterations;
+    }
+
+    double Result::allocBytesPerIter() const {
+        return static_cast<double>(allocBytes) / iterations;
+    }
+
+    void report(const Result & r) {
+        if (r.bytes != 0) {
+            std::printf("%-40s %12.1f us/iter %10.1f MB/s", r.name.c_str(), r.usPerIter(), r.mbps());
+        } else {
+            std::printf("%-40s %12.1f us/iter %10s     ", r.name.c_str(), r.usPerIter(), "-");
+        }
+
+        std::printf(" %10.1f allocs/iter %12.0f B/iter\n", r.allocsPerIter(), r.allocBytesPerIter());
+    }
+
+    void writeJSON(std::FILE * out, const std::vector<std::pair<std::string, std::vector<Result>>> & results) {
+        std::fprintf(out, "{\n  \"version\": ");
+        jsonString(out, PInfo::VERSION);
+        std::fprintf(out, ",\n  \"results\": [");
+
+        bool first = true;
+
+        for (auto & grp : results) {
+            for (auto & r : grp.second) {
+                std::fprintf(out, first ? "\n    {" : ",\n    {");
+                first = false;
+
+                std::fprintf(out, "\"group\": ");
+                jsonString(out, grp.first);
+                std::fprintf(out, ", \"name\": ");
+                jsonString(out, r.name);
+
+                std::fprintf(out, ", \"bytes\": %zu, \"iterations\": %zu, \"seconds\": %.6f, \"us_per_iter\": %.3f",
+                             r.bytes, r.iterations, r.seconds, r.usPerIter());
+
+                if (r.bytes != 0) {
+                    std::fprintf(out, ", \"mb_per_s\": %.3f", r.mbps());
+                } else {
+                    std::fprintf(out, ", \"mb_per_s\": null");
+                }
+
+                std::fprintf(out, ", \"allocs_per_iter\": %.3f, \"alloc_bytes_per_iter\": %.1f}",
+                             r.allocsPerIter(), r.allocBytesPerIter());
+            }
+        }
+
+        std::fprintf(out, "\n  ]\n}\n");
+    }
+}
\ No newline at end of file
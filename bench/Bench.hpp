@@ -0,0 +1,129 @@
+/** \file Bench.hpp
+ *
+ *  \brief Declares the bits shared by all the benchmarks.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Bench {
+    /** \brief Outcome of running one benchmark
+     */
+    struct Result {
+        std::string name;  ///< what was measured
+        size_t bytes;      ///< bytes processed per iteration, or 0 if throughput makes no sense for it
+        size_t iterations; ///< how many times it ran
+        double seconds;    ///< total time over all iterations
+
+        size_t allocs = 0;     ///< heap allocations made over all iterations
+        size_t allocBytes = 0; ///< bytes asked for by those allocations
+
+        /** \brief Returns the throughput in MB/s (10^6 bytes).
+         */
+        double mbps() const;
+
+        /** \brief Returns the time per iteration in microseconds.
+         */
+        double usPerIter() const;
+
+        /** \brief Returns the average number of allocations per iteration.
+         */
+        double allocsPerIter() const;
+
+        /** \brief Returns the average number of bytes allocated per iteration.
+         */
+        double allocBytesPerIter() const;
+    };
+
+    /** \brief Heap allocations counted so far
+     *
+     *  The benchmark program replaces the global \c operator \c new to keep
+     *  these counts, for every thread.
+     *
+     */
+    struct AllocCount {
+        size_t count; ///< number of allocations
+        size_t bytes; ///< total bytes asked for
+    };
+
+    /** \brief Returns the allocations made by the program so far.
+     */
+    AllocCount allocations();
+
+    /** \brief Minimum time, in seconds, to spend on each benchmark
+     */
+    const double MIN_TIME = 0.5;
+
+    /** \brief Runs a function repeatedly and times it.
+     *
+     *  The function is run once untimed to warm up, then as many times as it
+     *  takes to fill \c MIN_TIME (at least three). Heap allocations are
+     *  counted over the timed runs.
+     *
+     *  \param[in] name What to call this in the results.
+     *
+     *  \param[in] bytes How many bytes one call processes, for throughput.
+     *
+     *  \param[in] fn The function to time.
+     *
+     *  \returns The timing results.
+     *
+     */
+    template<typename Func>
+    Result measure(const std::string & name, size_t bytes, Func fn) {
+        typedef std::chrono::steady_clock clock;
+
+        fn();
+
+        Result res{name, bytes, 0, 0};
+
+        AllocCount before = allocations();
+        clock::time_point start = clock::now();
+
+        do {
+            fn();
+            res.iterations++;
+            res.seconds = std::chrono::duration<double>(clock::now() - start).count();
+        } while (res.seconds < MIN_TIME || res.iterations < 3);
+
+        AllocCount after = allocations();
+
+        res.allocs = after.count - before.count;
+        res.allocBytes = after.bytes - before.bytes;
+
+        return res;
+    }
+
+    /** \brief Prints a result as one line of the results table.
+     */
+    void report(const Result & r);
+
+    /** \brief Writes results as a JSON document.
+     *
+     *  The document is an object holding the program version and a \c
+     *  results array, with one object per result giving its group, name and
+     *  every measurement (throughput is \c null for results without a byte
+     *  count). This is meant for keeping track of results between versions.
+     *
+     *  \param[in] out Where to write the document.
+     *
+     *  \param[in] results Each group's name, and the results it gave.
+     *
+     */
+    void writeJSON(std::FILE * out, const std::vector<std::pair<std::string, std::vector<Result>>> & results);
+
+    std::vector<Result> yaz0();
+    std::vector<Result> byteswap();
+    std::vector<Result> crc();
+    std::vector<Result> rom();
+    std::vector<Result> dl();
+    std::vector<Result> text();
+    std::vector<Result> config();
+}
\ No newline at end of file
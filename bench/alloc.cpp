@@ -0,0 +1,79 @@
+/** \file alloc.cpp
+ *
+ *  \brief Replaces the global allocation functions to count allocations.
+ *
+ *  Counting is just two relaxed atomic adds per allocation, which is cheap
+ *  next to the allocation itself, so the timings are barely affected.
+ *
+ */
+
+#include "Bench.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<size_t> allocCount{0};
+    std::atomic<size_t> allocBytes{0};
+
+    void * countedAlloc(size_t size) {
+        allocCount.fetch_add(1, std::memory_order_relaxed);
+        allocBytes.fetch_add(size, std::memory_order_relaxed);
+
+        // malloc(0) may give back null, which new isn't allowed to
+        return std::malloc(size == 0 ? 1 : size);
+    }
+}
+
+namespace Bench {
+    AllocCount allocations() {
+        return AllocCount{allocCount.load(std::memory_order_relaxed), allocBytes.load(std::memory_order_relaxed)};
+    }
+}
+
+void * operator new(size_t size) {
+    void * res = countedAlloc(size);
+
+    if (res == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return res;
+}
+
+void * operator new[](size_t size) {
+    return operator new(size);
+}
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void * operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void * ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void * ptr, const std::nothrow_t &) noexcept {
+    std::free(ptr);
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+/** \file byteswap.cpp
+ *
+ *  \brief Benchmarks for normalizing byteswapped ROMs.
+ *
+ */
+
+#include "Bench.hpp"
+#include "byteswap.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Bench {
+    std::vector<Result> byteswap() {
+        // as big as the largest ROMs out there
+        std::vector<uint8_t> buf(64 * 1024 * 1024);
+        std::iota(buf.begin(), buf.end(), 0);
+
+        std::vector<Result> res;
+
+        // the loop ROM::unByteSwap used to have
+        res.push_back(measure("byteswap 16-bit, 64 MiB (old loop)", buf.size(), [&]() {
+            for (size_t i = 0; i + 1 < buf.size(); i += 2) {
+                std::swap(buf[i], buf[i + 1]);
+            }
+        }));
+
+        res.push_back(measure("byteswap 16-bit, 64 MiB", buf.size(), [&]() {
+            byteswap16(buf.data(), buf.size());
+        }));
+
+        res.push_back(measure("byteswap 32-bit, 64 MiB", buf.size(), [&]() {
+            byteswap32(buf.data(), buf.size());
+        }));
+
+        return res;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+/** \file config.cpp
+ *
+ *  \brief Benchmarks for reading config files.
+ *
+ */
+
+#include "Bench.hpp"
+#include "ConfigTree.hpp"
+#include "projectinfo.hpp"
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace Bench {
+    std::vector<Result> config() {
+        std::vector<Result> res;
+
+        // the two biggest ones there are, one per game
+        for (auto & name : {"oot_mq_debug.cfg", "mm_debug.cfg"}) {
+            std::string path = PInfo::DEVSHAREPATH + name;
+
+            std::ifstream sizer(path, std::ios::binary | std::ios::ate);
+
+            if (!sizer) {
+                throw std::runtime_error("couldn't open " + path);
+            }
+
+            size_t size = sizer.tellg();
+
+            res.push_back(measure(std::string("config parse, ") + name, size, [&]() {
+                std::ifstream cfile(path);
+                ConfigTree tree(cfile);
+            }));
+
+            std::ifstream cfile(path);
+            ConfigTree tree(cfile);
+
+            res.push_back(measure(std::string("config file name map, ") + name, 0, [&]() {
+                tree.numericValueKeys({"fileList"});
+            }));
+        }
+
+        return res;
+    }
+}
\ No newline at end of file
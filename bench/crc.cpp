@@ -0,0 +1,97 @@
+/** \file crc.cpp
+ *
+ *  \brief Benchmarks for calculating ROM CRCs.
+ *
+ */
+
+#include "Bench.hpp"
+#include "ROMCRC.hpp"
+#include "endian.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <random>
+
+namespace {
+    /** \brief The original CRC calculation, kept around to compare against.
+     */
+    std::pair<uint32_t, uint32_t> oldCRC(const uint8_t * rdata) {
+        uint32_t seed = 0x5D588B65u * 0x91u + 1u;
+
+        std::array<uint32_t, 6> reg; reg.fill(seed);
+
+        std::vector<uint8_t> chkthis;
+        std::copy(rdata + 0x1000, rdata + 0x101000,
+                  std::back_inserter(chkthis));
+
+        std::vector<uint8_t> extra;
+        std::copy(rdata + 0x750, rdata + 0x850,
+                  std::back_inserter(extra));
+
+        auto iter = chkthis.begin();
+
+        while (iter < chkthis.end()) {
+            uint32_t i = be_u32(iter);
+
+            if (reg[0] + i < reg[0]) {
+                reg[1]++;
+            }
+
+            uint32_t val = i & 0x1F;
+            val = (i << val) | (i >> (32 - val));
+
+            reg[0] += i;
+            reg[2] ^= i;
+            reg[3] += val;
+
+            reg[4] ^= (reg[4] < i)
+                    ? (reg[0] ^ i)
+                    : val;
+
+            size_t exidx = std::distance(chkthis.begin(), iter) % extra.size();
+            reg[5] += i ^ be_u32(extra.begin() + exidx);
+
+            iter += 4;
+        }
+
+        return std::make_pair(reg[0] ^ reg[1] ^ reg[2], reg[3] ^ reg[4] ^ reg[5]);
+    }
+}
+
+namespace Bench {
+    std::vector<Result> crc() {
+        std::mt19937 rng(64);
+
+        std::vector<uint8_t> rom(0x200000);
+        std::generate(rom.begin(), rom.end(), rng);
+
+        const size_t covered = ROM::CRCState::END - ROM::CRCState::START;
+
+        std::vector<Result> res;
+
+        res.push_back(measure("crc full (old, copying)", covered, [&]() {
+            oldCRC(rom.data());
+        }));
+
+        res.push_back(measure("crc full", covered, [&]() {
+            ROM::CRCState(rom.data()).result();
+        }));
+
+        ROM::CRCState state(rom.data());
+
+        // the order-dependent register has to be redone from the edit on, so
+        // updates cost more the earlier the edit is
+        res.push_back(measure("crc update, word near start", 4, [&]() {
+            rom[0x1000]++;
+            state.update(rom.data(), 0x1000, 0x1004);
+        }));
+
+        res.push_back(measure("crc update, word near end", 4, [&]() {
+            rom[0x100000]++;
+            state.update(rom.data(), 0x100000, 0x100004);
+        }));
+
+        return res;
+    }
+}
\ No newline at end of file
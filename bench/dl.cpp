@@ -0,0 +1,175 @@
+/** \file dl.cpp
+ *
+ *  \brief Benchmarks for finding display lists.
+ *
+ */
+
+#include "Bench.hpp"
+#include "RCP/DisplayList.hpp"
+#include "endian.hpp"
+
+#include <map>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    /** \brief Makes something laid out roughly like an object file.
+     *
+     *  Display lists of typical commands are separated by blocks of vertex
+     *  and texture data, which occasionally look enough like commands to be
+     *  picked up too, as in real files.
+     *
+     *  \param[in] rng Where to get the data from.
+     *  \param[in] size Size of the object.
+     *  \param[in] maxData Largest block of data between lists, in 16-byte units.
+     *  \param[in] dataMask Mask applied to each byte of data; the default keeps
+     *                      it to small values, like vertices.
+     *
+     */
+    std::vector<uint8_t> fakeObject(std::mt19937 & rng, size_t size,
+                                    size_t maxData = 0x110, uint8_t dataMask = 0x3F) {
+        const std::vector<uint64_t> setup{
+            0xE700000000000000uLL, // G_RDPPIPESYNC
+            0xFC127E24FFFFF9FCuLL, // G_SETCOMBINE
+            0xE200001C0C184DD8uLL, // G_SETOTHERMODE_L
+            0xD9F3FFFF00000000uLL, // G_GEOMETRYMODE
+            0xD9FFFFFF00030400uLL, // G_GEOMETRYMODE
+            0xFA000000FFFFFFFFuLL, // G_SETPRIMCOLOR
+            0xFD10000006001000uLL, // G_SETTIMG
+            0xE600000000000000uLL, // G_RDPLOADSYNC
+            0xF30000000703F800uLL, // G_LOADBLOCK
+            0xDA38000306000000uLL, // G_MTX
+        };
+
+        std::vector<uint8_t> res(size);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::uniform_int_distribution<size_t> blocks(16, maxData);
+
+        size_t pos = 0;
+
+        while (pos + maxData * 16 + 0x400 < size) {
+            // vertices and texels
+            size_t dataSize = blocks(rng) * 16;
+
+            for (size_t i = 0; i < dataSize; i++) {
+                res[pos + i] = byte(rng) & dataMask;
+            }
+
+            pos += dataSize;
+
+            // then a display list using them
+            auto put = [&](uint64_t cmd) {
+                be_write_u32(res.begin() + pos, cmd >> 32);
+                be_write_u32(res.begin() + pos + 4, cmd);
+                pos += 8;
+            };
+
+            for (auto & i : setup) {
+                put(i);
+            }
+
+            for (int v = 0; v < 4; v++) {
+                put(0x0102004006000000uLL | (uint64_t(v) << 12)); // G_VTX
+
+                for (int t = 0; t < 8; t++) {
+                    put(0x0600020400060800uLL); // G_TRI2
+                }
+
+                put(0x0500020400000000uLL); // G_TRI1
+            }
+
+            put(0xDF00000000000000uLL); // G_ENDDL
+        }
+
+        return res;
+    }
+
+    /** \brief Runs \c getDLs over data and throws away what it finds.
+     */
+    void findAll(const std::vector<uint8_t> & data) {
+        std::map<size_t, RCP::DisplayList> dls = RCP::getDLs(data.begin(), data.end());
+    }
+}
+
+namespace Bench {
+    std::vector<Result> dl() {
+        std::mt19937 rng(64);
+
+        std::vector<Result> res;
+
+        std::vector<uint8_t> object = fakeObject(rng, 256 * 1024);
+
+        res.push_back(measure("getDLs, 256 KiB object", object.size(), [&]() {
+            findAll(object);
+        }));
+
+        // as big as the largest objects in the games, to see how it scales
+        std::vector<uint8_t> bigObject = fakeObject(rng, 4 * 1024 * 1024);
+
+        res.push_back(measure("getDLs, 4 MiB object", bigObject.size(), [&]() {
+            findAll(bigObject);
+        }));
+
+        // mostly textures, with any byte values, so many more words look like
+        // commands but turn out not to be
+        std::vector<uint8_t> texObject = fakeObject(rng, 4 * 1024 * 1024, 0x1000, 0xFF);
+
+        res.push_back(measure("getDLs, 4 MiB texture-heavy object", texObject.size(), [&]() {
+            findAll(texObject);
+        }));
+
+        // without any ENDDLs there's nothing to parse, so this is just the
+        // cost of looking
+        std::vector<uint8_t> noise(256 * 1024);
+        std::uniform_int_distribution<int> byte(0, 255);
+
+        for (auto & i : noise) {
+            i = byte(rng);
+        }
+
+        res.push_back(measure("getDLs, 256 KiB without DLs", noise.size(), [&]() {
+            findAll(noise);
+        }));
+
+        // a model's worth of decoded commands, picked through the way an
+        // interpreter would for every frame
+        std::vector<std::unique_ptr<RCP::Command::Any>> cmds;
+
+        for (size_t i = 0; i < 4096; i++) {
+            switch (i % 4) {
+              case 0:
+                cmds.emplace_back(new RCP::Command::VTX(0x0102004006000000uLL));
+                break;
+
+              case 1:
+                cmds.emplace_back(new RCP::Command::TRI2(0x0600020400060800uLL));
+                break;
+
+              case 2:
+                cmds.emplace_back(new RCP::Command::TRI1(0x0500020400000000uLL));
+                break;
+
+              case 3:
+                cmds.emplace_back(new RCP::Command::RDPPIPESYNC(0xE700000000000000uLL));
+                break;
+            }
+        }
+
+        size_t tris = 0;
+
+        res.push_back(measure("command_cast, 4096 commands", 0, [&]() {
+            for (auto & i : cmds) {
+                tris += RCP::command_cast<RCP::Command::TRI2 *>(i.get()) != nullptr;
+            }
+        }));
+
+        // (which also keeps the casts from being optimized out)
+        if (tris % 1024 != 0) {
+            throw std::runtime_error("command_cast picked out the wrong commands");
+        }
+
+        return res;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/** \file main.cpp
+ *
+ *  \brief Entry point for the benchmark program.
+ *
+ *  Run with no arguments to do every benchmark, or name the groups you want.
+ *  With \c --json, the results are written as JSON instead of a table, for
+ *  comparing between versions.
+ *
+ */
+
+#include "Bench.hpp"
+
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+
+int main(int argc, char ** argv) {
+    std::map<std::string, std::function<std::vector<Bench::Result>()>> groups{
+        {"yaz0", Bench::yaz0},
+        {"byteswap", Bench::byteswap},
+        {"crc", Bench::crc},
+        {"rom", Bench::rom},
+        {"dl", Bench::dl},
+        {"text", Bench::text},
+        {"config", Bench::config},
+    };
+
+    std::vector<std::string> wanted;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--json") {
+            json = true;
+        } else {
+            wanted.push_back(argv[i]);
+        }
+    }
+
+    if (wanted.empty()) {
+        for (auto & i : groups) {
+            wanted.push_back(i.first);
+        }
+    }
+
+    std::vector<std::pair<std::string, std::vector<Bench::Result>>> results;
+
+    for (auto & i : wanted) {
+        auto grp = groups.find(i);
+
+        if (grp == groups.end()) {
+            std::fprintf(stderr, "Unknown benchmark group \"%s\".\n", i.c_str());
+            return 1;
+        }
+
+        results.emplace_back(i, grp->second());
+
+        if (!json) {
+            for (auto & r : results.back().second) {
+                Bench::report(r);
+            }
+        }
+    }
+
+    if (json) {
+        Bench::writeJSON(stdout, results);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+/** \file rom.cpp
+ *
+ *  \brief Benchmarks for opening ROMs.
+ *
+ */
+
+#include "Bench.hpp"
+#include "ROM.hpp"
+#include "ROMGen.hpp"
+#include "ROMDLIndex.hpp"
+#include "ROMIndexCache.hpp"
+
+#include <QTemporaryDir>
+
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    /** \brief Writes a ROM image to a file, so it can be opened like a real
+     *         one (mapped, that is).
+     */
+    std::string saveROM(const QTemporaryDir & dir, const std::string & name, const std::vector<uint8_t> & data) {
+        std::string path = dir.path().toStdString() + "/" + name;
+
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char *>(data.data()), data.size());
+
+        if (!out) {
+            throw std::runtime_error("couldn't write " + path);
+        }
+
+        return path;
+    }
+}
+
+namespace Bench {
+    std::vector<Result> rom() {
+        QTemporaryDir tmp;
+
+        if (!tmp.isValid()) {
+            throw std::runtime_error("couldn't make a temporary directory");
+        }
+
+        const size_t MIB = 1024 * 1024;
+
+        // about as many files as the real games have, then several times
+        // that to see how the TOC reading scales
+        ROM::GenOptions usualOpts;
+        usualOpts.maxFileSize = 0x4000;
+        usualOpts.minSize = 32 * MIB;
+
+        std::string usual = saveROM(tmp, "usual.z64", ROM::generate(usualOpts).data);
+        std::string many = saveROM(tmp, "many.z64", ROM::generate(ROM::manyFilesShape()).data);
+
+        // a hack that moved things around, making us search for "zelda@"
+        ROM::GenOptions movedOpts = usualOpts;
+        movedOpts.tocOffset = 24 * MIB;
+
+        std::string moved = saveROM(tmp, "moved.z64", ROM::generate(movedOpts).data);
+
+        ROM::GenOptions swappedOpts = usualOpts;
+        swappedOpts.order = ROM::ByteOrder::SWAPPED_16;
+
+        std::string v64 = saveROM(tmp, "swapped.v64", ROM::generate(swappedOpts).data);
+
+        // and one four times the biggest real ROM
+        std::string huge = saveROM(tmp, "huge.z64", ROM::generate(ROM::hugeImageShape()).data);
+
+        // something like the model files, half compressed, for finding
+        // display lists in
+        ROM::GenOptions modelOpts;
+        modelOpts.files = 600;
+        modelOpts.compressed = 0.5;
+
+        std::string models = saveROM(tmp, "models.z64", ROM::generate(modelOpts).data);
+
+        std::string indexDir = tmp.path().toStdString();
+
+        std::vector<Result> res;
+
+        res.push_back(measure("rom open, 1500 files", 0, [&]() {
+            ROM::ROM opened(std::make_shared<ROM::Source>(usual));
+        }));
+
+        res.push_back(measure("rom open, 10000 files", 0, [&]() {
+            ROM::ROM opened(std::make_shared<ROM::Source>(many));
+        }));
+
+        res.push_back(measure("rom open, build string moved", 24 * MIB, [&]() {
+            ROM::ROM opened(std::make_shared<ROM::Source>(moved));
+        }));
+
+        res.push_back(measure("rom open, byteswapped", 32 * MIB, [&]() {
+            ROM::ROM opened(std::make_shared<ROM::Source>(v64));
+        }));
+
+        // the warmup run fills in the cache entry, so this is all hits. A
+        // hit only reads up to the end of the TOC, so there's no throughput
+        // to speak of.
+        res.push_back(measure("rom open, index cache hit", 0, [&]() {
+            ROM::ROM opened(std::make_shared<ROM::Source>(usual), indexDir);
+        }));
+
+        res.push_back(measure("rom open, 256 MiB", 0, [&]() {
+            ROM::ROM opened(std::make_shared<ROM::Source>(huge));
+        }));
+
+        res.push_back(measure("rom open, 256 MiB, index cache hit", 0, [&]() {
+            ROM::ROM opened(std::make_shared<ROM::Source>(huge), indexDir);
+        }));
+
+        ROM::ROM loaded(std::make_shared<ROM::Source>(usual));
+
+        res.push_back(measure("rom record lookup by address, 1500 files", 0, [&]() {
+            for (size_t i = 0; i < loaded.numFiles(); i += 7) {
+                loaded.recordAtVAddress(loaded.recordAtNum(i).vstart);
+            }
+        }));
+
+        // generated ROMs have no file names, so there are no model files to
+        // speak of, and every file gets scanned instead
+        ROM::ROM modelROM(std::make_shared<ROM::Source>(models));
+
+        std::vector<size_t> all(modelROM.numFiles());
+        std::iota(all.begin(), all.end(), 0);
+
+        size_t plainSize = 0;
+
+        for (auto & i : all) {
+            plainSize += modelROM.recordAtNum(i).isMissing() ? 0 : modelROM.recordAtNum(i).vsize();
+        }
+
+        ROM::DLIndex found;
+
+        res.push_back(measure("rom dl scan, 600 files", plainSize, [&]() {
+            found = ROM::scanDLs(modelROM, all);
+        }));
+
+        if (found.lists.empty() || !found.failed.empty()) {
+            throw std::runtime_error("scanning the generated ROM didn't work");
+        }
+
+        ROM::IndexCache cache(indexDir);
+        cache.saveDLs(modelROM.size(), modelROM.getCRC(), found);
+
+        res.push_back(measure("rom dl scan, index cache hit", 0, [&]() {
+            ROM::DLIndex cached;
+
+            if (!cache.loadDLs(modelROM.size(), modelROM.getCRC(), ROM::dlSourceHash(modelROM, all), cached)) {
+                throw std::runtime_error("the display list index wasn't cached");
+            }
+        }));
+
+        return res;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+/** \file text.cpp
+ *
+ *  \brief Benchmarks for decoding messages.
+ *
+ */
+
+#include "Bench.hpp"
+#include "TextConv.hpp"
+
+#include <string>
+#include <vector>
+
+namespace {
+    /** \brief Makes a run of Ocarina of Time messages in ASCII.
+     *
+     *  Each one has a few lines of text with some color changes and the
+     *  player's name, and every fourth has a second box.
+     *
+     */
+    std::vector<uint8_t> fakeMessagesOoT(size_t count) {
+        const std::string line = "You got the  Kokiri Sword ! This is a test line.";
+
+        std::vector<uint8_t> res;
+
+        for (size_t i = 0; i < count; i++) {
+            for (int j = 0; j < 3; j++) {
+                res.insert(res.end(), line.begin(), line.begin() + 12);
+                res.insert(res.end(), {0x05, 0x41});
+                res.insert(res.end(), line.begin() + 12, line.begin() + 26);
+                res.insert(res.end(), {0x05, 0x40});
+                res.insert(res.end(), line.begin() + 26, line.end());
+                res.push_back(0x0F);
+                res.push_back(0x01);
+            }
+
+            if (i % 4 == 0) {
+                res.push_back(0x04);
+                res.insert(res.end(), line.begin(), line.end());
+            }
+
+            res.push_back(0x02);
+        }
+
+        return res;
+    }
+
+    /** \brief Makes a run of Majora's Mask messages in Shift-JIS.
+     *
+     *  Same idea as the OoT ones: a few lines of hiragana, with some color
+     *  changes.
+     *
+     */
+    std::vector<uint8_t> fakeMessagesMM(size_t count) {
+        std::vector<uint8_t> res;
+
+        for (size_t i = 0; i < count; i++) {
+            for (int j = 0; j < 3; j++) {
+                for (int k = 0; k < 20; k++) {
+                    if (k == 5) {
+                        res.insert(res.end(), {0x20, 0x01});
+                    } else if (k == 12) {
+                        res.insert(res.end(), {0x20, 0x00});
+                    }
+
+                    res.push_back(0x82);
+                    res.push_back(0xA0 + (i + j + k) % 0x50);
+                }
+
+                res.insert(res.end(), {0x00, 0x0A});
+            }
+
+            res.insert(res.end(), {0x05, 0x00});
+        }
+
+        return res;
+    }
+
+    /** \brief Decodes every message in a run of them with the given reader.
+     */
+    template<typename Reader>
+    void readAll(const std::vector<uint8_t> & msgs, size_t count, Reader reader) {
+        const uint8_t * ptr = msgs.data();
+
+        for (size_t i = 0; i < count; i++) {
+            reader(ptr);
+        }
+    }
+}
+
+namespace Bench {
+    std::vector<Result> text() {
+        // about as many as there are in a language of one of the games
+        const size_t COUNT = 2000;
+
+        std::vector<Result> res;
+
+        std::vector<uint8_t> oot = fakeMessagesOoT(COUNT);
+
+        res.push_back(measure("readASCII_OoT, 2000 messages", oot.size(), [&]() {
+            readAll(oot, COUNT, readASCII_OoT);
+        }));
+
+        std::vector<uint8_t> mm = fakeMessagesMM(COUNT);
+
+        res.push_back(measure("readShiftJIS_MM, 2000 messages", mm.size(), [&]() {
+            readAll(mm, COUNT, readShiftJIS_MM);
+        }));
+
+        return res;
+    }
+}
\ No newline at end of file
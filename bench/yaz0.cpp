@@ -0,0 +1,173 @@
+/** \file yaz0.cpp
+ *
+ *  \brief Benchmarks for Yaz0 compression and decompression.
+ *
+ */
+
+#include "Bench.hpp"
+#include "yaz0.hpp"
+#include "endian.hpp"
+#include "Exceptions.hpp"
+
+#include <random>
+
+namespace {
+    /** \brief The original decoder, kept around to compare against.
+     *
+     *  This is how \c yaz0_decompress worked before being rewritten over raw
+     *  pointers, minus the padding check at the end.
+     *
+     */
+    std::vector<uint8_t> oldDecompress(std::vector<uint8_t> ciphertext) {
+        std::string magic(ciphertext.begin(), ciphertext.begin() + 4);
+
+        if (magic != "Yaz0" && magic != "Yaz1") {
+            throw X::Yaz0::Decompress("Not actually a compressed file.");
+        }
+
+        uint32_t dsize = be_u32(ciphertext.begin() + 4);
+
+        std::vector<uint8_t> plaintext(dsize, 0);
+
+        auto cipher_R_pnt = ciphertext.begin() + 16;
+        auto plain_R_pnt  = plaintext.begin();
+        auto plain_W_pnt  = plaintext.begin();
+
+        while (cipher_R_pnt != ciphertext.end() && plain_W_pnt != plaintext.end()) {
+            uint8_t opset = *cipher_R_pnt++;
+
+            for (uint8_t i = 7; i <= 7; i--) {
+                if (cipher_R_pnt == ciphertext.end() || plain_W_pnt == plaintext.end()) {
+                    break;
+                }
+
+                if (opset & (1 << i)) {
+                    *plain_W_pnt++ = *cipher_R_pnt++;
+                } else {
+                    uint16_t readcnt = (*cipher_R_pnt) >> 4;
+                    uint16_t backamt = (*cipher_R_pnt++) & 0x0F;
+                    backamt = (backamt << 8) | *cipher_R_pnt++;
+                    backamt++;
+
+                    if (readcnt == 0) {
+                        readcnt = *cipher_R_pnt++ + 0x10;
+                    }
+
+                    readcnt += 0x2;
+
+                    plain_R_pnt = plain_W_pnt - backamt;
+
+                    for (uint16_t i = 0; i < readcnt; i++) {
+                        *plain_W_pnt++ = *plain_R_pnt++;
+                    }
+                }
+            }
+        }
+
+        if (plain_W_pnt != plaintext.end()) {
+            throw X::Yaz0::Decompress("Some kind of problem with decompressing, didn't fill up plaintext exactly.");
+        }
+
+        return plaintext;
+    }
+
+    /** \brief Makes a file that compresses roughly like real game data.
+     *
+     *  Mixes runs of zeros, repeated 8-byte "commands" with varying
+     *  arguments, low-entropy "texture" bytes and plain noise.
+     *
+     */
+    std::vector<uint8_t> fakeFile(std::mt19937 & rng, size_t size) {
+        std::vector<uint8_t> res;
+        res.reserve(size);
+
+        while (res.size() < size) {
+            size_t chunk = 64 + rng() % 2048;
+
+            switch (rng() % 4) {
+              case 0:
+                res.insert(res.end(), chunk, 0);
+                break;
+
+              case 1:
+                for (size_t i = 0; i < chunk; i += 8) {
+                    uint8_t op[8] = {0xDA, 0x38, 0x00, 0x03, 0x06, 0x00, 0x00, 0x00};
+                    op[0] = 0xD0 + rng() % 8;
+                    op[6] = rng() % 4;
+                    op[7] = (rng() % 16) * 8;
+                    res.insert(res.end(), op, op + 8);
+                }
+                break;
+
+              case 2:
+                for (size_t i = 0; i < chunk; i++) {
+                    res.push_back(0x40 + rng() % 8);
+                }
+                break;
+
+              case 3:
+                for (size_t i = 0; i < chunk / 4; i++) {
+                    res.push_back(rng());
+                }
+                break;
+            }
+        }
+
+        res.resize(size);
+
+        return res;
+    }
+}
+
+namespace Bench {
+    std::vector<Result> yaz0() {
+        std::mt19937 rng(64);
+
+        std::vector<std::vector<uint8_t>> plain;
+        size_t total = 0;
+
+        // file sizes spread like an actual ROM's: mostly small, some big
+        for (size_t i = 0; i < 64; i++) {
+            size_t sz = 0x1000 + rng() % (i % 8 == 0 ? 0x40000 : 0x10000);
+
+            plain.push_back(fakeFile(rng, sz));
+            total += sz;
+        }
+
+        std::vector<std::vector<uint8_t>> comp = yaz0_compress_all(plain);
+
+        std::vector<uint8_t> outbuf(0x50000);
+
+        std::vector<Result> res;
+
+        res.push_back(measure("yaz0 decompress (old, by value)", total, [&]() {
+            for (auto & i : comp) {
+                oldDecompress(i);
+            }
+        }));
+
+        res.push_back(measure("yaz0 decompress (into buffer)", total, [&]() {
+            for (auto & i : comp) {
+                yaz0_decompress_into(i.data(), i.size(), outbuf.data(), outbuf.size());
+            }
+        }));
+
+        res.push_back(measure("yaz0 compress (fast)", total, [&]() {
+            for (auto & i : plain) {
+                yaz0_compress(i, Yaz0Level::FAST);
+            }
+        }));
+
+        res.push_back(measure("yaz0 compress (normal)", total, [&]() {
+            for (auto & i : plain) {
+                yaz0_compress(i, Yaz0Level::NORMAL);
+            }
+        }));
+
+        res.push_back(measure("yaz0 compress all (normal, parallel)", total, [&]() {
+            yaz0_compress_all(plain, Yaz0Level::NORMAL);
+        }));
+
+        return res;
+    }
+}
\ No newline at end of file
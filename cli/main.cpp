@@ -0,0 +1,353 @@
+/** \file main.cpp
+ *
+ *  \brief Entry point for the command-line program.
+ *
+ *  This does the things the GUI does that are worth scripting, without
+ *  needing a display. Everything is written out as it's found, so even
+ *  extracting or dumping a whole ROM doesn't build up its output in memory.
+ *
+ */
+
+#include "ROM.hpp"
+#include "ROMDiff.hpp"
+#include "ROMDLIndex.hpp"
+#include "ROMIndexCache.hpp"
+#include "TextConv.hpp"
+#include "TextAST.hpp"
+#include "RCP/DisplayList.hpp"
+#include "Exceptions.hpp"
+#include "Parallel.hpp"
+#include "utility.hpp"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QString>
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    typedef std::vector<std::string> Args;
+
+    /** \brief One subcommand of the program
+     */
+    struct Command {
+        std::string usage; ///< arguments it takes, for the help text
+        std::string help;  ///< what it does, for the help text
+        size_t minArgs;    ///< fewest arguments it needs
+        std::function<int(const Args &)> run; ///< does it, returning the exit status
+    };
+
+    bool useIndexCache = true;
+
+    std::unique_ptr<ROM::ROM> openROM(const std::string & fname) {
+        return std::unique_ptr<ROM::ROM>(new ROM::ROM(std::make_shared<ROM::Source>(fname),
+                                                      useIndexCache ? ROM::defaultIndexDir() : ""));
+    }
+
+    std::string hex(size_t val, int width) {
+        std::stringstream res;
+        res << std::hex << std::uppercase << std::setfill('0') << std::setw(width) << val;
+        return res.str();
+    }
+
+    std::string orderName(ROM::ByteOrder bo) {
+        switch (bo) {
+          case ROM::ByteOrder::BIG:
+            return "big-endian (z64)";
+            break;
+
+          case ROM::ByteOrder::SWAPPED_16:
+            return "byteswapped (v64)";
+            break;
+
+          case ROM::ByteOrder::SWAPPED_32:
+            return "word-swapped (n64)";
+            break;
+        }
+
+        return "";
+    }
+
+    /** \brief Finds a file by its name, or by its starting address if given
+     *         a hex number.
+     */
+    ROM::Record findRecord(const ROM::ROM & rom, const std::string & which) {
+        if (which.size() > 2 && which[0] == '0' && (which[1] == 'x' || which[1] == 'X')) {
+            return rom.recordAtVAddress(std::stoul(which, nullptr, 16));
+        }
+
+        return rom.recordAtName(which);
+    }
+
+    int info(const Args & args) {
+        auto rom = openROM(args[0]);
+
+        ROM::ROM::CRCPair stored = rom->getCRC();
+        ROM::ROM::CRCPair calced = rom->calcCRC();
+
+        size_t compressed = 0;
+        size_t missing = 0;
+
+        for (size_t i = 0; i < rom->numFiles(); i++) {
+            ROM::Record r = rom->recordAtNum(i);
+
+            compressed += r.isCompressed();
+            missing += r.isMissing();
+        }
+
+        std::cout << "Name:       " << rom->get_rname() << "\n"
+                  << "Code:       " << rom->get_rcode() << "\n"
+                  << "Version:    " << Config::vDisplayStr(rom->getVersion()) << "\n"
+                  << "Size:       " << sizeToIEC(rom->size()) << "\n"
+                  << "Byte order: " << orderName(rom->originalByteOrder()) << "\n"
+                  << "CRC:        " << hex(stored.first, 8) << " " << hex(stored.second, 8)
+                  << (stored == calced ? " (OK)" : " (should be " + hex(calced.first, 8) + " " + hex(calced.second, 8) + ")")
+                  << "\n"
+                  << "Files:      " << rom->numFiles() << " (" << compressed << " compressed, "
+                  << missing << " missing)\n";
+
+        return stored == calced ? 0 : 2;
+    }
+
+    int list(const Args & args) {
+        auto rom = openROM(args[0]);
+
+        for (size_t i = 0; i < rom->numFiles(); i++) {
+            ROM::Record r = rom->recordAtNum(i);
+
+            std::cout << std::setw(4) << i << "  "
+                      << hex(r.vstart, 8) << " " << hex(r.vend, 8) << "  "
+                      << hex(r.pstart, 8) << " " << hex(r.pend, 8) << "  "
+                      << (r.isMissing() ? 'M' : r.isCompressed() ? 'C' : '-') << "  "
+                      << r.fname << "\n";
+        }
+
+        return 0;
+    }
+
+    int extract(const Args & args) {
+        bool decompress = false;
+        Args rest;
+
+        for (auto & i : args) {
+            if (i == "-d" || i == "--decompress") {
+                decompress = true;
+            } else {
+                rest.push_back(i);
+            }
+        }
+
+        if (rest.size() != 2) {
+            std::cerr << "extract needs a ROM and an output directory.\n";
+            return 1;
+        }
+
+        auto rom = openROM(rest[0]);
+
+        QString outdir = QString::fromStdString(rest[1]);
+
+        if (!QDir().mkpath(outdir)) {
+            std::cerr << "Couldn't create directory " << rest[1] << ".\n";
+            return 1;
+        }
+
+        std::mutex outLock;
+        bool failed = false;
+
+        // each file is read, decompressed and written on its own, so only as
+        // many files as there are threads are ever in memory at once.
+        Parallel::forEachIndex(rom->numFiles(), [&](size_t idx) {
+            ROM::Record r = rom->recordAtNum(idx);
+
+            if (r.isMissing() || r.vsize() == 0) {
+                return;
+            }
+
+            std::string fname = rest[1] + "/" + hex(idx, 4) + "_" + hex(r.vstart, 8)
+                                + (r.fname.empty() ? "" : "_" + r.fname) + ".bin";
+
+            try {
+                // go around the ROM's cache, there's no point in keeping
+                // anything we're only writing out once
+                ROM::File rf = rom->fileAtNum(idx, false);
+
+                if (decompress) {
+                    rf = rf.decompress();
+                }
+
+                std::ofstream outfile(fname, std::ios::binary);
+                outfile.write(reinterpret_cast<const char *>(rf.data()), rf.size());
+
+                if (!outfile) {
+                    throw X::ROM::OpenError("couldn't write " + fname);
+                }
+
+                std::lock_guard<std::mutex> guard(outLock);
+                std::cout << fname << "\n";
+            } catch (Exception & e) {
+                std::lock_guard<std::mutex> guard(outLock);
+                std::cerr << fname << ": " << e.what() << "\n";
+                failed = true;
+            }
+        });
+
+        return failed ? 1 : 0;
+    }
+
+    int text(const Args & args) {
+        auto rom = openROM(args[0]);
+
+        TextAST::MessageIndex midx = TextAST::analyzeMsgTbl(*rom);
+
+        for (auto & lang : midx) {
+            for (auto & msg : lang.second) {
+                TextAST::MsgInfo minfo = msg.second;
+
+                std::cout << "% " << Config::langString(lang.first) << " 0x" << hex(msg.first, 4) << "\n";
+
+                try {
+                    std::cout << TextAST::messageAsCode(readMessage(*rom, lang.first, minfo)) << "\n\n";
+                } catch (Exception & e) {
+                    std::cout << "% " << e.what() << "\n\n";
+                }
+            }
+        }
+
+        return 0;
+    }
+
+    int dl(const Args & args) {
+        auto rom = openROM(args[0]);
+
+        ROM::File rf = rom->fileAtVAddress(findRecord(*rom, args[1]).vstart);
+
+        std::map<size_t, RCP::DisplayList> dls = RCP::getDLs(rf.begin(), rf.end());
+
+        for (auto & i : dls) {
+            std::cout << "0x" << hex(i.first, 6) << ":\n";
+
+            for (auto & j : i.second) {
+                std::cout << "    " << j.name() << "\n";
+            }
+
+            std::cout << "\n";
+        }
+
+        return 0;
+    }
+
+    int dls(const Args & args) {
+        auto rom = openROM(args[0]);
+
+        ROM::DLIndex idx = ROM::modelDLIndex(*rom, useIndexCache ? ROM::defaultIndexDir() : "");
+
+        if (idx.files.empty()) {
+            std::cerr << "No object, scene or room files are known for this ROM.\n";
+            return 1;
+        }
+
+        for (auto & i : idx.failed) {
+            std::cerr << "Couldn't read " << rom->recordAtNum(i).fname << ".\n";
+        }
+
+        for (auto & i : idx.lists) {
+            std::cout << rom->recordAtNum(i.file).fname << " 0x" << hex(i.offset, 6) << " " << i.length << ":";
+
+            for (auto & j : i.histogram) {
+                std::cout << " " << RCP::kindName(j.kind) << "=" << j.count;
+            }
+
+            std::cout << "\n";
+        }
+
+        return 0;
+    }
+
+    int diff(const Args & args) {
+        auto older = openROM(args[0]);
+        auto newer = openROM(args[1]);
+
+        ROM::ROMDiff res = ROM::diffROMs(*older, *newer);
+
+        ROM::writeDiffReport(std::cout, res, SIZE_MAX);
+
+        return res.count(ROM::FileDiff::Change::SAME) == res.files.size() ? 0 : 2;
+    }
+
+    void usage(const std::map<std::string, Command> & cmds) {
+        std::cerr << "Usage: z64fe-cli [--no-index-cache] <command> <arguments>\n\nCommands:\n";
+
+        for (auto & i : cmds) {
+            std::cerr << "  " << i.first << " " << i.second.usage << "\n"
+                      << "      " << i.second.help << "\n";
+        }
+    }
+}
+
+int main(int argc, char ** argv) {
+    QCoreApplication qca(argc, argv);
+
+    // the same names as the GUI, so we find the same config files and share
+    // its index cache
+    QCoreApplication::setOrganizationName("ShimmerFairy");
+    QCoreApplication::setApplicationName("Z64Fe");
+    QCoreApplication::setApplicationVersion("0.0.0");
+
+    std::map<std::string, Command> cmds{
+        {"info", {"<rom>", "Shows what the ROM is, and checks its CRC.", 1, info}},
+        {"list", {"<rom>", "Lists the files in the ROM's table of contents.", 1, list}},
+        {"extract", {"[-d|--decompress] <rom> <dir>", "Writes every file to the directory, decompressed if asked.", 2, extract}},
+        {"text", {"<rom>", "Dumps all the messages in the ROM.", 1, text}},
+        {"dl", {"<rom> <name|0xvaddr>", "Dumps the display lists found in a file.", 2, dl}},
+        {"dls", {"<rom>", "Lists the display lists in every object, scene and room file, and what commands they use.", 1, dls}},
+        {"diff", {"<old rom> <new rom>", "Lists how the files of the new ROM differ from the old.", 2, diff}},
+    };
+
+    Args args(argv + 1, argv + argc);
+
+    if (!args.empty() && args[0] == "--no-index-cache") {
+        useIndexCache = false;
+        args.erase(args.begin());
+    }
+
+    if (args.empty()) {
+        usage(cmds);
+        return 1;
+    }
+
+    auto cmd = cmds.find(args[0]);
+
+    if (cmd == cmds.end()) {
+        std::cerr << "Unknown command \"" << args[0] << "\".\n\n";
+        usage(cmds);
+        return 1;
+    }
+
+    args.erase(args.begin());
+
+    if (args.size() < cmd->second.minArgs) {
+        usage(cmds);
+        return 1;
+    }
+
+    try {
+        return cmd->second.run(args);
+    } catch (Exception & e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    } catch (std::exception & e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+}
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <map>
 #include <string>
 
@@ -48,6 +49,27 @@ namespace Config {
     Game getGame(Version v);
     Region getRegion(Version v);
 
+    /** \brief Returns where the TOC usually sits in ROMs of this version.
+     *
+     *  These are the locations in unmodified dumps; hacked ROMs may well
+     *  have moved things around, so this is only good as a first guess. The
+     *  build string ("zelda@...") is always 0x30 bytes before the TOC.
+     *
+     *  \returns Offset of the TOC, or 0 for \c Version::UNKNOWN.
+     *
+     */
+    size_t tocOffset(Version v);
+
+    /** \brief Returns the compile timestamp found in ROMs of this version.
+     *
+     *  This is the string following the build string, which is how we tell
+     *  versions apart in the first place.
+     *
+     *  \returns The timestamp, or an empty string for \c Version::UNKNOWN.
+     *
+     */
+    std::string compileTime(Version v);
+
     enum class Language {
         JP,
         EN,
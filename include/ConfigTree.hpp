@@ -11,6 +11,8 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <unordered_map>
+#include <cstdint>
 #include <initializer_list>
 
 /** \brief One node of a config tree
@@ -67,6 +69,33 @@ class ConfigTree {
     std::string getValue(std::initializer_list<std::string> vp) const;
 
     std::string findKey(std::initializer_list<std::string> ingroup, std::string findval) const;
+
+    /** \brief Maps each numeric value in a group to its key.
+     *
+     *  This is the reverse lookup of \c findKey() for a whole group at once,
+     *  for values that are hex numbers (like \c 0x00001060). Only the group's
+     *  direct children are included, and if a value appears more than once
+     *  the first key with it wins. Values that aren't hex numbers are
+     *  skipped.
+     *
+     *  \param[in] ingroup Path to the group.
+     *
+     *  \returns The map from values to keys, empty if the group doesn't
+     *           exist.
+     *
+     */
+    std::unordered_map<uint32_t, std::string> numericValueKeys(std::initializer_list<std::string> ingroup) const;
 };
 
+/** \brief Returns the path of the config file for a version.
+ *
+ *  Installed config files are preferred over the ones in the source tree.
+ *
+ *  \param[in] forVer The version to look for.
+ *
+ *  \returns The file's path, or an empty string if there isn't one.
+ *
+ */
+std::string configFilePath(Config::Version forVer);
+
 ConfigTree getConfigTree(Config::Version forVer);
\ No newline at end of file
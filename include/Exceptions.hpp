@@ -86,6 +86,31 @@ namespace X {
           public:
             std::string what() override;
         };
+
+        class OpenError : public Exception {
+          private:
+            std::string reason;
+
+          public:
+            OpenError(std::string r);
+
+            std::string what() override;
+        };
+
+        class Cancelled : public Exception {
+          public:
+            std::string what() override;
+        };
+
+        class GenError : public Exception {
+          private:
+            std::string reason;
+
+          public:
+            GenError(std::string r);
+
+            std::string what() override;
+        };
     }
 
     namespace Config {
@@ -141,6 +166,16 @@ namespace X {
 
             std::string what() override;
         };
+
+        class Compress : public Exception {
+          private:
+            std::string reason;
+
+          public:
+            Compress(std::string r);
+
+            std::string what() override;
+        };
     }
 
     namespace Text {
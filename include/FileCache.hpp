@@ -0,0 +1,172 @@
+/** \file FileCache.hpp
+ *
+ *  \brief Declares a thread-safe cache for ROM files.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace ROM {
+    class File;
+
+    /** \brief Thread-safe cache of Files
+     *
+     *  This is the cache the ROM uses to remember files it's already loaded
+     *  (in particular decompressed ones, which are costly to produce). It's
+     *  safe to use from multiple threads at once, so files can be loaded in
+     *  the background while the UI goes on browsing the ROM.
+     *
+     *  Entries are split across a number of shards, each with its own lock,
+     *  so threads looking up different files rarely wait on each other. The
+     *  locks are only held for the map lookup itself, never while a file is
+     *  being loaded.
+     *
+     *  Each entry is a \c std::shared_ptr<const File>, so whoever gets one can
+     *  keep using it no matter what the cache does afterwards.
+     *
+     *  If several threads ask for the same file before it's loaded, only the
+     *  first one actually loads it; the others wait for that result instead
+     *  of doing the same work again.
+     *
+     *  The cache keeps to a budget of bytes, counting the size of each cached
+     *  File. When it goes over budget, the least recently used entries are
+     *  dropped (each shard gets an equal part of the budget and evicts on its
+     *  own). So this should only hold Files that own their data; a File that's
+     *  just a view into the ROM costs nothing to remake and isn't worth
+     *  caching.
+     *
+     */
+    class FileCache {
+      public:
+        typedef std::shared_ptr<const File> Entry; ///< What the cache hands out
+        typedef std::function<File()> Loader;      ///< Produces a file on a cache miss
+
+        static const size_t DEFAULT_BUDGET = 256 * 1024 * 1024; ///< default byte budget
+
+        /** \brief Snapshot of the cache's counters
+         */
+        struct Stats {
+            size_t hits;          ///< lookups that found the file already cached (or being loaded)
+            size_t misses;        ///< lookups that had to load the file
+            size_t evictions;     ///< entries dropped to stay within budget
+            size_t residentBytes; ///< total size of the files currently cached
+        };
+
+      private:
+        /** \brief One cached file, or one that's being loaded
+         */
+        struct Slot {
+            std::shared_future<Entry> result; ///< the file, when ready
+            bool ready = false;               ///< if \c result has been set
+            size_t bytes = 0;                 ///< size counted against the budget
+            std::list<size_t>::iterator age;  ///< place in the shard's LRU list, once ready
+        };
+
+        /** \brief One independently-locked part of the cache
+         */
+        struct Shard {
+            std::mutex lock;                          ///< guards everything else here
+            std::unordered_map<size_t, Slot> entries; ///< finished or in-progress loads
+            std::list<size_t> lru;                    ///< keys of ready entries, most recently used first
+            size_t resident = 0;                      ///< bytes of ready entries in this shard
+        };
+
+        static const size_t NUM_SHARDS = 16; ///< number of shards, should be a power of two
+
+        std::array<Shard, NUM_SHARDS> shards; ///< the shards themselves
+
+        std::atomic<size_t> budget{DEFAULT_BUDGET}; ///< byte budget for the whole cache
+
+        std::atomic<size_t> hits{0};      ///< see Stats
+        std::atomic<size_t> misses{0};    ///< see Stats
+        std::atomic<size_t> evictions{0}; ///< see Stats
+        std::atomic<size_t> resident{0};  ///< see Stats
+
+        /** \brief Picks the shard a key belongs in.
+         *
+         *  Keys are virtual addresses, whose low bits are usually all zero,
+         *  so the key is mixed a bit before picking.
+         *
+         */
+        Shard & shardFor(size_t key);
+
+        /** \brief Drops least recently used entries until the shard fits its
+         *         part of the budget.
+         *
+         *  The most recently used entry is always kept, even if it alone is
+         *  over budget. The shard's lock must be held.
+         *
+         */
+        void evictLocked(Shard & sh);
+
+      public:
+        FileCache() = default;
+
+        FileCache(const FileCache &) = delete;
+        FileCache & operator=(const FileCache &) = delete;
+
+        /** \brief Gets the file for a key, loading it if needed.
+         *
+         *  If the key isn't in the cache yet, \c load is called (on the
+         *  calling thread, without any locks held) to produce the file, and
+         *  the result is remembered for next time. If another thread is
+         *  already loading the same key, this waits for that thread's result
+         *  instead.
+         *
+         *  If loading throws, the exception is passed on to everyone waiting
+         *  for the file, and nothing is cached, so a later call tries again.
+         *
+         *  \param[in] key Key identifying the file (e.g. its virtual address)
+         *
+         *  \param[in] load Function producing the file on a miss.
+         *
+         *  \returns The cached file.
+         *
+         */
+        Entry get(size_t key, const Loader & load);
+
+        /** \brief Forgets every cached file.
+         *
+         *  Files that were already handed out stay valid.
+         *
+         */
+        void clear();
+
+        /** \brief Sets the cache's byte budget.
+         *
+         *  Evicts right away if the cache is now over budget.
+         *
+         *  \param[in] bytes New budget, in bytes.
+         *
+         */
+        void setBudget(size_t bytes);
+
+        /** \brief Returns the cache's byte budget.
+         *
+         *  \returns Budget in bytes.
+         *
+         */
+        size_t getBudget() const;
+
+        /** \brief Returns the cache's counters.
+         *
+         *  The counters are read one at a time while other threads may be
+         *  using the cache, so the snapshot isn't necessarily consistent
+         *  across fields.
+         *
+         *  \returns The current counter values.
+         *
+         */
+        Stats stats() const;
+    };
+}
\ No newline at end of file
@@ -13,6 +13,8 @@
 #include <QMainWindow>
 #include <QMdiArea>
 #include <QDockWidget>
+#include <QFutureWatcher>
+#include <QProgressDialog>
 
 #include <cstdint>
 #include <vector>
@@ -50,6 +52,7 @@ class MainWindow : public QMainWindow {
     QToolBar * actions_toolbar; ///< The main toolbar of the window
 
     QAction * load_rom;  ///< Action for loading a ROM file
+    QAction * diff_rom;  ///< Action for comparing another ROM file to this one
     QAction * exit_prog; ///< Action for exiting the program
 
     QAction * about_this; ///< Action displaying about this program.
@@ -57,6 +60,42 @@ class MainWindow : public QMainWindow {
 
     ROM::ROM * the_rom; ///< ROM file currently in use (this class owns the pointer)
 
+    /** \brief What opening a ROM in the background came to
+     */
+    struct OpenResult {
+        ROM::ROM * rom = nullptr; ///< The new ROM, or \c nullptr if it didn't open (or was only compared)
+        bool compared = false;    ///< If the ROM was compared against the current one instead
+        QString report;           ///< The comparison, if that's what was done
+        QString errTitle;         ///< Title of the error to show, if it didn't
+        QString errText;          ///< The error itself, empty if it was cancelled
+    };
+
+    QFutureWatcher<OpenResult> open_watcher; ///< Watches the ROM being opened, if any
+    ROM::OpenMonitor * open_monitor;         ///< Follows (and cancels) that opening
+    QProgressDialog * open_progress;         ///< Shows how far that opening is
+    QString open_compare;                    ///< Name of the ROM being compared against the current one, if that's why it's opening
+
+    /** \brief Returns the index cache directory to open ROMs with.
+     *
+     *  \returns The directory, or an empty string if the index cache is
+     *           turned off (or can't be made).
+     *
+     */
+    static std::string indexCacheDir();
+
+    /** \brief Starts opening a ROM file on another thread.
+     *
+     *  Progress is shown as it goes, and \c finishOpen() takes the result.
+     *
+     *  \param[in] fileName The file to open.
+     *
+     *  \param[in] compare If the ROM should be compared against the current
+     *                     one (on the same thread, after opening), rather than
+     *                     replace it.
+     *
+     */
+    void startOpen(const QString & fileName, bool compare);
+
   private slots:
     /** \brief Qt slot for opening a ROM
      *
@@ -65,9 +104,39 @@ class MainWindow : public QMainWindow {
      *  will perform the parts of the loading operation it needs to do. (The
      *  actual ROM processing is handled elsewhere.)
      *
+     *  The ROM is opened on another thread, with its progress shown and a
+     *  chance to cancel it. The current ROM stays in use until the new one is
+     *  ready (see \c finishOpen()).
+     *
      */
     void openROM();
 
+    /** \brief Qt slot for showing the stage a ROM being opened is at
+     *
+     *  \param[in] stage The \c ROM::OpenStage reached, as an \c int.
+     *
+     */
+    void showOpenStage(int stage);
+
+    /** \brief Qt slot for when a ROM is done opening
+     *
+     *  If the ROM opened, it replaces the current one, or if it was opened
+     *  to compare, the comparison is shown. Otherwise the user is told why
+     *  not, and keeps the ROM they had.
+     *
+     */
+    void finishOpen();
+
+    /** \brief Qt slot for comparing another ROM to the current one
+     *
+     *  This asks for a ROM file and shows how its files differ from the
+     *  current ROM's (taking the current ROM as the original), in a new
+     *  window. Opening the other ROM and comparing both happen on another
+     *  thread, just like \c openROM().
+     *
+     */
+    void compareROM();
+
     void makeHexWindow(ROM::File rf);
     void makeTextWindow();
     void makeObjWindow(ROM::File rf);
@@ -87,6 +156,10 @@ class MainWindow : public QMainWindow {
   signals:
     void romChanged(ROM::ROM * tr);
 
+    /** \brief Emitted from the opening thread as it reaches each stage.
+     */
+    void openStageReached(int stage);
+
   public:
     /** \brief Constructs the window to prepare for being shown.
      *
@@ -0,0 +1,58 @@
+/** \file Parallel.hpp
+ *
+ *  \brief Small helpers for running work across all cores.
+ *
+ */
+
+#pragma once
+
+#include <QtConcurrent>
+
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <vector>
+
+namespace Parallel {
+    /** \brief Calls a function for every index in <tt>[0, count)</tt>, in
+     *         parallel.
+     *
+     *  This runs on Qt's global thread pool, and only returns once every call
+     *  is done. The order of the calls is unspecified, so \c fn must be safe to
+     *  call from several threads at once.
+     *
+     *  QtConcurrent only passes on exceptions derived from \c QException, so
+     *  this catches whatever \c fn throws itself; once everything's finished,
+     *  the first exception caught (if any) is rethrown on the calling thread.
+     *
+     *  \param[in] count Number of indices.
+     *
+     *  \param[in] fn Function taking a \c size_t index.
+     *
+     */
+    template<typename Func>
+    void forEachIndex(size_t count, Func fn) {
+        std::vector<size_t> idxs(count);
+        std::iota(idxs.begin(), idxs.end(), 0);
+
+        std::exception_ptr failure;
+        std::mutex failLock;
+
+        QtConcurrent::blockingMap(idxs, [&](size_t & i) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(failLock);
+
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        });
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+}
\ No newline at end of file
@@ -14,17 +14,124 @@
 #include "Exceptions.hpp"
 #include "Fixed.hpp"
 
+#include <cassert>
 #include <cstdint>
 #include <string>
 #include <array>
-#include <deque>
+#include <vector>
 #include <map>
-
-#include <iostream>
+#include <type_traits>
 
 namespace RCP {
+    /** \brief A bit field of a command
+     *
+     *  Commands pack their values into bit fields of a 64-bit word. Each
+     *  command's layout is written down once as a set of these, so reading a
+     *  value comes down to a shift and a mask the compiler can see all of.
+     *
+     *  \tparam OFFSET The field's lowest bit.
+     *
+     *  \tparam WIDTH How many bits the field has.
+     *
+     *  \tparam T The type to read the field as. If it's signed, the field is
+     *           taken as two's complement and sign-extended.
+     *
+     */
+    template<unsigned OFFSET, unsigned WIDTH, typename T = uint32_t>
+    struct Field {
+        static_assert(WIDTH > 0 && OFFSET + WIDTH <= 64, "Field doesn't fit in a command");
+        static_assert(std::is_integral<T>::value && WIDTH <= sizeof(T) * 8, "Field doesn't fit its type");
+
+        /** \brief Reads the field from a command.
+         */
+        static constexpr T get(uint64_t instr) {
+            uint64_t raw = instr >> OFFSET & (~uint64_t(0) >> (64 - WIDTH));
+
+            if (std::is_signed<T>::value) {
+                // flipping the sign bit and taking it away again extends it,
+                // without any conversions the standard leaves open
+                uint64_t sign = uint64_t(1) << (WIDTH - 1);
+
+                return static_cast<T>(static_cast<int64_t>(raw ^ sign) - static_cast<int64_t>(sign));
+            }
+
+            return static_cast<T>(raw);
+        }
+    };
+
     namespace Command {
+        /** \brief The kinds of commands we know
+         *
+         *  One for each class below. \c QUAD is read as \c TRI2, so it doesn't
+         *  get its own.
+         *
+         */
+        enum class Kind : uint8_t {
+            NOOP,
+            VTX,
+            MODIFYVTX,
+            CULLDL,
+            BRANCH_Z,
+            TRI1,
+            TRI2,
+            DMA_IO,
+            TEXTURE,
+            POPMTX,
+            GEOMETRYMODE,
+            MTX,
+            MOVEWORD,
+            MOVEMEM,
+            LOAD_UCODE,
+            DL,
+            ENDDL,
+            SPNOOP,
+            RDPHALF_1,
+            SETOTHERMODE_L,
+            SETOTHERMODE_H,
+            TEXRECT,
+            TEXRECTFLIP,
+            RDPLOADSYNC,
+            RDPPIPESYNC,
+            RDPTILESYNC,
+            RDPFULLSYNC,
+            SETKEYGB,
+            SETKEYR,
+            SETCONVERT,
+            SETSCISSOR,
+            SETPRIMDEPTH,
+            RDPSETOTHERMODE,
+            LOADTLUT,
+            RDPHALF_2,
+            SETTILESIZE,
+            LOADBLOCK,
+            LOADTILE,
+            SETTILE,
+            FILLRECT,
+            SETFILLCOLOR,
+            SETFOGCOLOR,
+            SETBLENDCOLOR,
+            SETPRIMCOLOR,
+            SETENVCOLOR,
+            SETCOMBINE,
+            SETTIMG,
+            SETZIMG,
+            SETCIMG,
+        };
+
+        /** \brief How many kinds of commands there are
+         */
+        const size_t NUM_KINDS = static_cast<size_t>(Kind::SETCIMG) + 1;
+
         class Any {
+          private:
+            Kind the_kind;
+
+          protected:
+            /** \brief Tags the command with its kind, which subclasses give
+             *         as their \c KIND.
+             */
+            Any(Kind k) : the_kind(k) { }
+
           public:
             // XXX if we ever get the ability to demand constructors from
             // subclasses, put that here.
@@ -33,11 +140,36 @@ namespace RCP {
 
             virtual std::string id() = 0;
 
+            /** \brief Returns which command this is.
+             *
+             *  Unlike \c id(), this is a plain value, so checking the kind of
+             *  a command (or switching on it) costs no more than comparing
+             *  two integers.
+             *
+             */
+            Kind kind() const { return the_kind; }
+
+            /** \brief Checks a command's values, without decoding it.
+             *
+             *  Commands with values that can be wrong hide this with their
+             *  own checks; their constructors throw the same problem as a \c
+             *  X::RCP::BadCommand.
+             *
+             *  \param[in] instr The command, with the right opcode.
+             *
+             *  \returns What's wrong with the command, or \c nullptr if
+             *           nothing is.
+             *
+             */
+            static const char * problem(uint64_t instr);
+
             virtual ~Any() { }
         };
 
         class NOOP : public Any {
           public:
+            static constexpr Kind KIND = Kind::NOOP;
+
             uint32_t tag;
 
             NOOP(uint64_t instr);
@@ -48,18 +180,24 @@ namespace RCP {
 
         class VTX : public Any {
           public:
+            static constexpr Kind KIND = Kind::VTX;
+
             uint8_t size;
             uint8_t dst_idx;
             uint32_t ram_address;
 
             VTX(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class MODIFYVTX : public Any {
           public:
+            static constexpr Kind KIND = Kind::MODIFYVTX;
+
             enum class Change {
                 RGBA     = 0x10,
                 ST       = 0x14,
@@ -73,49 +211,67 @@ namespace RCP {
 
             MODIFYVTX(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class CULLDL : public Any {
           public:
+            static constexpr Kind KIND = Kind::CULLDL;
+
             uint16_t begin_idx;
             uint16_t end_idx;
 
             CULLDL(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class BRANCH_Z : public Any {
           public:
+            static constexpr Kind KIND = Kind::BRANCH_Z;
+
             uint16_t test_idx;
             uint16_t test_idx_2;
             uint32_t z_value;
 
             BRANCH_Z(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class TRI1 : public Any {
           public:
+            static constexpr Kind KIND = Kind::TRI1;
+
             std::array<uint8_t, 3> vtx_idxs;
 
             TRI1(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class TRI2 : public Any {
           public:
+            static constexpr Kind KIND = Kind::TRI2;
+
             std::array<uint8_t, 6> vtx_idxs;
 
             TRI2(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
@@ -126,6 +282,8 @@ namespace RCP {
 
         class DMA_IO : public Any {
           public:
+            static constexpr Kind KIND = Kind::DMA_IO;
+
             enum class Mode {
                 ToRCP,
                 FromRCP,
@@ -138,12 +296,16 @@ namespace RCP {
 
             DMA_IO(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class TEXTURE : public Any {
           public:
+            static constexpr Kind KIND = Kind::TEXTURE;
+
             uint8_t extra_mipmaps;
             uint8_t tile_no;
             bool on;
@@ -152,22 +314,30 @@ namespace RCP {
 
             TEXTURE(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class POPMTX : public Any {
           public:
+            static constexpr Kind KIND = Kind::POPMTX;
+
             uint32_t pop_num;
 
             POPMTX(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class GEOMETRYMODE : public Any {
           public:
+            static constexpr Kind KIND = Kind::GEOMETRYMODE;
+
             uint32_t clear_this;
             uint32_t set_this;
 
@@ -179,6 +349,8 @@ namespace RCP {
 
         class MTX : public Any {
           public:
+            static constexpr Kind KIND = Kind::MTX;
+
             enum class Loading {
                 Load,
                 Multiply,
@@ -196,12 +368,16 @@ namespace RCP {
 
             MTX(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class MOVEWORD : public Any {
           public:
+            static constexpr Kind KIND = Kind::MOVEWORD;
+
             enum class Index {
                 Matrix    = 0x00,
                 NumLight  = 0x02,
@@ -219,12 +395,16 @@ namespace RCP {
 
             MOVEWORD(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class MOVEMEM : public Any {
           public:
+            static constexpr Kind KIND = Kind::MOVEMEM;
+
             enum class Index {
                 Viewport = 0x08,
                 Light    = 0x0A,
@@ -234,27 +414,35 @@ namespace RCP {
             uint8_t size;
             uint8_t offset;
             Index idx;
-            uint8_t src_address;
+            uint32_t src_address;
 
             MOVEMEM(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class LOAD_UCODE : public Any {
           public:
+            static constexpr Kind KIND = Kind::LOAD_UCODE;
+
             uint16_t data_size;
             uint32_t text_start;
 
             LOAD_UCODE(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class DL : public Any {
           public:
+            static constexpr Kind KIND = Kind::DL;
+
             enum class Style {
                 Call,
                 Jump,
@@ -265,12 +453,16 @@ namespace RCP {
 
             DL(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class ENDDL : public Any {
           public:
+            static constexpr Kind KIND = Kind::ENDDL;
+
             ENDDL(uint64_t instr);
 
             static std::string sid();
@@ -279,6 +471,8 @@ namespace RCP {
 
         class SPNOOP : public Any {
           public:
+            static constexpr Kind KIND = Kind::SPNOOP;
+
             SPNOOP(uint64_t instr);
 
             static std::string sid();
@@ -287,6 +481,8 @@ namespace RCP {
 
         class RDPHALF_1 : public Any {
           public:
+            static constexpr Kind KIND = Kind::RDPHALF_1;
+
             uint32_t high_word;
 
             RDPHALF_1(uint64_t instr);
@@ -298,12 +494,16 @@ namespace RCP {
         // XXX unpack "value" instead
         class SETOTHERMODE_L : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETOTHERMODE_L;
+
             uint8_t shift;
             uint8_t size;
             uint32_t value;
 
             SETOTHERMODE_L(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
@@ -311,12 +511,16 @@ namespace RCP {
         // XXX unpack "value" instead
         class SETOTHERMODE_H : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETOTHERMODE_H;
+
             uint8_t shift;
             uint8_t size;
             uint32_t value;
 
             SETOTHERMODE_H(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
@@ -324,6 +528,8 @@ namespace RCP {
         // note: assumes 64-bit variant only, at least for now.
         class TEXRECT : public Any {
           public:
+            static constexpr Kind KIND = Kind::TEXRECT;
+
             ufix<10, 2> lrx;
             ufix<10, 2> lry;
             uint8_t tile_no;
@@ -338,6 +544,8 @@ namespace RCP {
 
         class TEXRECTFLIP : public Any {
           public:
+            static constexpr Kind KIND = Kind::TEXRECTFLIP;
+
             ufix<10, 2> lrx;
             ufix<10, 2> lry;
             uint8_t tile_no;
@@ -352,6 +560,8 @@ namespace RCP {
 
         class RDPLOADSYNC : public Any {
           public:
+            static constexpr Kind KIND = Kind::RDPLOADSYNC;
+
             RDPLOADSYNC(uint64_t instr);
 
             static std::string sid();
@@ -360,6 +570,8 @@ namespace RCP {
 
         class RDPPIPESYNC : public Any {
           public:
+            static constexpr Kind KIND = Kind::RDPPIPESYNC;
+
             RDPPIPESYNC(uint64_t instr);
 
             static std::string sid();
@@ -368,6 +580,8 @@ namespace RCP {
 
         class RDPTILESYNC : public Any {
           public:
+            static constexpr Kind KIND = Kind::RDPTILESYNC;
+
             RDPTILESYNC(uint64_t instr);
 
             static std::string sid();
@@ -376,6 +590,8 @@ namespace RCP {
 
         class RDPFULLSYNC : public Any {
           public:
+            static constexpr Kind KIND = Kind::RDPFULLSYNC;
+
             RDPFULLSYNC(uint64_t instr);
 
             static std::string sid();
@@ -384,6 +600,8 @@ namespace RCP {
 
         class SETKEYGB : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETKEYGB;
+
             ufix<4, 8> width_G;
             ufix<4, 8> width_B;
             uint8_t center_G;
@@ -399,6 +617,8 @@ namespace RCP {
 
         class SETKEYR : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETKEYR;
+
             ufix<4, 8> width_R;
             uint8_t center_R;
             uint8_t scale_R;
@@ -411,6 +631,8 @@ namespace RCP {
 
         class SETCONVERT : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETCONVERT;
+
             // actually signed 9-bit numbers
             std::array<sfix<9, 0>, 6> k;
 
@@ -422,6 +644,8 @@ namespace RCP {
 
         class SETSCISSOR : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETSCISSOR;
+
             enum class Mode {
                 All  = 0,
                 Even = 2,
@@ -436,12 +660,16 @@ namespace RCP {
 
             SETSCISSOR(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class SETPRIMDEPTH : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETPRIMDEPTH;
+
             int16_t Z;
             int16_t delta_Z;
 
@@ -453,6 +681,8 @@ namespace RCP {
 
         class RDPSETOTHERMODE : public Any {
           public:
+            static constexpr Kind KIND = Kind::RDPSETOTHERMODE;
+
             uint32_t high_bits;
             uint32_t low_bits;
 
@@ -464,17 +694,23 @@ namespace RCP {
 
         class LOADTLUT : public Any {
           public:
+            static constexpr Kind KIND = Kind::LOADTLUT;
+
             uint8_t tile_no;
             uint16_t last_color_idx;
 
             LOADTLUT(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class RDPHALF_2 : public Any {
           public:
+            static constexpr Kind KIND = Kind::RDPHALF_2;
+
             uint32_t low_word;
 
             RDPHALF_2(uint64_t instr);
@@ -485,6 +721,8 @@ namespace RCP {
 
         class SETTILESIZE : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETTILESIZE;
+
             ufix<10, 2> uls; // u10.2
             ufix<10, 2> ult; // u10.2
             uint8_t tile_no;
@@ -499,6 +737,8 @@ namespace RCP {
 
         class LOADBLOCK : public Any {
           public:
+            static constexpr Kind KIND = Kind::LOADBLOCK;
+
             ufix<10, 2> uls; // u10.2
             ufix<10, 2> ult; // u10.2
             uint8_t tile_no;
@@ -513,6 +753,8 @@ namespace RCP {
 
         class LOADTILE : public Any {
           public:
+            static constexpr Kind KIND = Kind::LOADTILE;
+
             ufix<10, 2> uls; // u10.2
             ufix<10, 2> ult; // u10.2
             uint8_t tile_no;
@@ -527,6 +769,8 @@ namespace RCP {
 
         class SETTILE : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETTILE;
+
             Image::Format tile_fmt;
             uint16_t u64_per_row;
             uint16_t tmem_address;
@@ -545,12 +789,16 @@ namespace RCP {
 
             SETTILE(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class FILLRECT : public Any {
           public:
+            static constexpr Kind KIND = Kind::FILLRECT;
+
             ufix<10, 2> lrx; // RCP truncated(?) to ints
             ufix<10, 2> lry; // RCP truncated(?) to ints
             ufix<10, 2> ulx; // RCP truncated(?) to ints
@@ -558,12 +806,16 @@ namespace RCP {
 
             FILLRECT(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class SETFILLCOLOR : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETFILLCOLOR;
+
             uint32_t rawval;
             // rawval is because the meaning drastically changes depending on
             // the situation, so we can't know until later.
@@ -576,6 +828,8 @@ namespace RCP {
 
         class SETFOGCOLOR : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETFOGCOLOR;
+
             uint8_t R;
             uint8_t G;
             uint8_t B;
@@ -589,6 +843,8 @@ namespace RCP {
 
         class SETBLENDCOLOR : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETBLENDCOLOR;
+
             uint8_t R;
             uint8_t G;
             uint8_t B;
@@ -602,6 +858,8 @@ namespace RCP {
 
         class SETPRIMCOLOR : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETPRIMCOLOR;
+
             ufix<0, 8> min_lod;  // u0.8
             ufix<0, 8> lod_frac; // u0.8
             uint8_t R;
@@ -617,6 +875,8 @@ namespace RCP {
 
         class SETENVCOLOR : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETENVCOLOR;
+
             uint8_t R;
             uint8_t G;
             uint8_t B;
@@ -630,6 +890,8 @@ namespace RCP {
 
         class SETCOMBINE : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETCOMBINE;
+
             CC::ColorA color_1a, color_2a;
             CC::ColorB color_1b, color_2b;
             CC::ColorC color_1c, color_2c;
@@ -647,34 +909,46 @@ namespace RCP {
 
         class SETTIMG : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETTIMG;
+
             Image::Format tile_fmt;
             uint16_t width;
             uint32_t ram_address;
 
             SETTIMG(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class SETZIMG : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETZIMG;
+
             uint32_t ram_address;
 
             SETZIMG(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
 
         class SETCIMG : public Any {
           public:
+            static constexpr Kind KIND = Kind::SETCIMG;
+
             Image::Format tile_fmt;
             uint16_t width;
             uint32_t ram_address;
 
             SETCIMG(uint64_t instr);
 
+            static const char * problem(uint64_t instr);
+
             static std::string sid();
             std::string id() override;
         };
@@ -683,23 +957,17 @@ namespace RCP {
     /** \brief Aid in casting RCP command items
      *
      *  Simply a helper cast-like function for neatly handling casting from a
-     *  generic command object to its specific subclass. It's basically a \c
-     *  dynamic_cast with built-in error-handling for our specific case.
+     *  generic command object to its specific subclass. Since every command
+     *  carries its kind, checking the cast is one integer comparison, and no
+     *  \c dynamic_cast is needed after it.
      *
      *  \tparam T Type to convert to. Type must be a pointer to a Command::Any
-     *            subclass, or another type that delegates to a Command::Any
-     *            subclass's static methods and which can accept an assignment
-     *            of \c nullptr.
+     *            subclass.
      *
      *  \param[in] ap Pointer to some kind of Command object
      *
-     *  \returns A dynamically-casted pointer to the specified type if possible,
-     *           or a \c nullptr if not possible.
-     *
-     *  \warning This will fail at compile time if static member function \c
-     *           T::sid() is not callable, or if \c T(nullptr) is not a valid
-     *           way to construct \c T, or if the given \c Command::Any object
-     *           can't be downcasted via \c dynamic_cast to \c T.
+     *  \returns A pointer to the specified type if the command is of that
+     *           kind, or a \c nullptr if not.
      *
      *  \note This function requires the user to explicitly give the type as a
      *        pointer only to maintain consistency with other casting functions.
@@ -707,26 +975,396 @@ namespace RCP {
      */
     template<typename T>
     T command_cast(Command::Any * ap) {
-        T res(nullptr);
+        typedef typename std::remove_pointer<T>::type Target;
+
+        static_assert(std::is_pointer<T>::value && std::is_base_of<Command::Any, Target>::value,
+                      "command_cast needs a pointer to a command class");
+
+        if (ap->kind() != Target::KIND) {
+            return nullptr;
+        }
+
+        return static_cast<T>(ap);
+    }
+
+    /** \brief One command of a display list
+     *
+     *  Commands are kept as the 64-bit words they were read from, tagged with
+     *  the kind of command they are, so a whole display list is one block of
+     *  plain values. The fields are only pulled out when asked for, by making
+     *  the matching \c Command class from the word.
+     *
+     */
+    struct Instruction {
+        uint64_t word;      ///< The command, as read
+        Command::Kind kind; ///< Which command it is
+
+        /** \brief Checks if this is the command of a Command class.
+         */
+        template<typename T>
+        bool is() const {
+            return kind == T::KIND;
+        }
+
+        /** \brief Decodes the command's fields.
+         *
+         *  \tparam T The Command class for \c kind.
+         *
+         *  \returns The decoded command.
+         *
+         */
+        template<typename T>
+        T as() const {
+            assert(is<T>());
+
+            return T(word);
+        }
+
+        /** \brief Returns the command's name, like \c "G_VTX".
+         */
+        const char * name() const;
+    };
+
+    typedef std::vector<Instruction> DisplayList;
+
+    /** \brief Returns the name of a kind of command, like \c "G_VTX".
+     */
+    const char * kindName(Command::Kind kind);
+
+    /** \brief What the commands with one opcode look like, and how to handle
+     *         them
+     *
+     *  Every command has some bits for its values, and the rest always set
+     *  the same way. Checking that second part is enough to throw out most
+     *  words that aren't commands, before looking at any values.
+     *
+     *  These make up the table of opcodes for the microcode, so everything
+     *  done with a command before decoding it is a lookup by its opcode
+     *  instead of a switch over all of them.
+     *
+     */
+    struct OpcodeShape {
+        bool known;         ///< If any command has this opcode
+        uint64_t varying;   ///< The bits that hold the command's values
+        uint64_t fixed;     ///< What all the other bits have to be
+        Command::Kind kind; ///< The command it is
+        const char * name;  ///< The command's name, like \c "G_VTX"
+
+        /** \brief The \c problem() of the command's class, or \c nullptr if
+         *         any values are fine.
+         */
+        const char * (*problem)(uint64_t);
+    };
+
+    /** \brief Returns the shape of commands with the given opcode.
+     *
+     *  \param[in] op The opcode, the top byte of a command.
+     *
+     *  \returns The shape, with \c known false if there's no such command.
+     *
+     *  \note Supporting another microcode would mean another one of these,
+     *        along with the field layouts its command classes read from.
+     *
+     */
+    constexpr OpcodeShape shapeOf(uint8_t op) {
+        switch (op) {
+          case 0x00:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0x0000000000000000uLL, Command::Kind::NOOP, "G_NOOP", nullptr};
+            break;
+
+          case 0x01:
+            return OpcodeShape{true, 0x000FF0FFFFFFFFFFuLL, 0x0100000000000000uLL, Command::Kind::VTX, "G_VTX", &Command::VTX::problem};
+            break;
+
+          case 0x02:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0x0200000000000000uLL, Command::Kind::MODIFYVTX, "G_MODIFYVTX", &Command::MODIFYVTX::problem};
+            break;
+
+          case 0x03:
+            return OpcodeShape{true, 0x0000FFFF0000FFFFuLL, 0x0300000000000000uLL, Command::Kind::CULLDL, "G_CULLDL", &Command::CULLDL::problem};
+            break;
+
+          case 0x04:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0x0400000000000000uLL, Command::Kind::BRANCH_Z, "G_BRANCH_Z", &Command::BRANCH_Z::problem};
+            break;
+
+          case 0x05:
+            return OpcodeShape{true, 0x00FFFFFF00000000uLL, 0x0500000000000000uLL, Command::Kind::TRI1, "G_TRI1", &Command::TRI1::problem};
+            break;
+
+          case 0x06:
+            return OpcodeShape{true, 0x00FFFFFF00FFFFFFuLL, 0x0600000000000000uLL, Command::Kind::TRI2, "G_TRI2", &Command::TRI2::problem};
+            break;
+
+          case 0x07:  // G_QUAD, read as G_TRI2
+            return OpcodeShape{true, 0x00FFFFFF00FFFFFFuLL, 0x0700000000000000uLL, Command::Kind::TRI2, "G_TRI2", &Command::TRI2::problem};
+            break;
+
+          case 0xD6:
+            return OpcodeShape{true, 0x00FFEFFFFFFFFFFFuLL, 0xD600000000000000uLL, Command::Kind::DMA_IO, "G_DMA_IO", &Command::DMA_IO::problem};
+            break;
+
+          case 0xD7:
+            return OpcodeShape{true, 0x00003FFFFFFFFFFFuLL, 0xD700000000000000uLL, Command::Kind::TEXTURE, "G_TEXTURE", &Command::TEXTURE::problem};
+            break;
+
+          case 0xD8:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xD838000200000000uLL, Command::Kind::POPMTX, "G_POPMTX", &Command::POPMTX::problem};
+            break;
+
+          case 0xD9:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0xD900000000000000uLL, Command::Kind::GEOMETRYMODE, "G_GEOMETRYMODE", nullptr};
+            break;
+
+          case 0xDA:
+            return OpcodeShape{true, 0x000000FFFFFFFFFFuLL, 0xDA38000000000000uLL, Command::Kind::MTX, "G_MTX", &Command::MTX::problem};
+            break;
+
+          case 0xDB:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0xDB00000000000000uLL, Command::Kind::MOVEWORD, "G_MOVEWORD", &Command::MOVEWORD::problem};
+            break;
+
+          case 0xDC:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0xDC00000000000000uLL, Command::Kind::MOVEMEM, "G_MOVEMEM", &Command::MOVEMEM::problem};
+            break;
+
+          case 0xDD:
+            return OpcodeShape{true, 0x0000FFFFFFFFFFFFuLL, 0xDD00000000000000uLL, Command::Kind::LOAD_UCODE, "G_LOAD_UCODE", &Command::LOAD_UCODE::problem};
+            break;
+
+          case 0xDE:
+            return OpcodeShape{true, 0x00FF0000FFFFFFFFuLL, 0xDE00000000000000uLL, Command::Kind::DL, "G_DL", &Command::DL::problem};
+            break;
+
+          case 0xDF:
+            return OpcodeShape{true, 0x0000000000000000uLL, 0xDF00000000000000uLL, Command::Kind::ENDDL, "G_ENDDL", nullptr};
+            break;
+
+          case 0xE0:
+            return OpcodeShape{true, 0x0000000000000000uLL, 0xE000000000000000uLL, Command::Kind::SPNOOP, "G_SPNOOP", nullptr};
+            break;
+
+          case 0xE1:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xE100000000000000uLL, Command::Kind::RDPHALF_1, "G_RDPHALF_1", nullptr};
+            break;
+
+          case 0xE2:
+            return OpcodeShape{true, 0x0000FFFFFFFFFFFFuLL, 0xE200000000000000uLL, Command::Kind::SETOTHERMODE_L, "G_SETOTHERMODE_L", &Command::SETOTHERMODE_L::problem};
+            break;
+
+          case 0xE3:
+            return OpcodeShape{true, 0x0000FFFFFFFFFFFFuLL, 0xE300000000000000uLL, Command::Kind::SETOTHERMODE_H, "G_SETOTHERMODE_H", &Command::SETOTHERMODE_H::problem};
+            break;
+
+          case 0xE4:
+            return OpcodeShape{true, 0x00FFFFFF07FFFFFFuLL, 0xE400000000000000uLL, Command::Kind::TEXRECT, "G_TEXRECT", nullptr};
+            break;
+
+          case 0xE5:
+            return OpcodeShape{true, 0x00FFFFFF07FFFFFFuLL, 0xE500000000000000uLL, Command::Kind::TEXRECTFLIP, "G_TEXRECTFLIP", nullptr};
+            break;
+
+          case 0xE6:
+            return OpcodeShape{true, 0x0000000000000000uLL, 0xE600000000000000uLL, Command::Kind::RDPLOADSYNC, "G_RDPLOADSYNC", nullptr};
+            break;
+
+          case 0xE7:
+            return OpcodeShape{true, 0x0000000000000000uLL, 0xE700000000000000uLL, Command::Kind::RDPPIPESYNC, "G_RDPPIPESYNC", nullptr};
+            break;
+
+          case 0xE8:
+            return OpcodeShape{true, 0x0000000000000000uLL, 0xE800000000000000uLL, Command::Kind::RDPTILESYNC, "G_RDPTILESYNC", nullptr};
+            break;
+
+          case 0xE9:
+            return OpcodeShape{true, 0x0000000000000000uLL, 0xE900000000000000uLL, Command::Kind::RDPFULLSYNC, "G_RDPFULLSYNC", nullptr};
+            break;
+
+          case 0xEA:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0xEA00000000000000uLL, Command::Kind::SETKEYGB, "G_SETKEYGB", nullptr};
+            break;
+
+          case 0xEB:
+            return OpcodeShape{true, 0x000000000FFFFFFFuLL, 0xEB00000000000000uLL, Command::Kind::SETKEYR, "G_SETKEYR", nullptr};
+            break;
+
+          case 0xEC:
+            return OpcodeShape{true, 0x003FFFFFFFFFFFFFuLL, 0xEC00000000000000uLL, Command::Kind::SETCONVERT, "G_SETCONVERT", nullptr};
+            break;
+
+          case 0xED:
+            return OpcodeShape{true, 0x00FFFFFFF0FFFFFFuLL, 0xED00000000000000uLL, Command::Kind::SETSCISSOR, "G_SETSCISSOR", &Command::SETSCISSOR::problem};
+            break;
+
+          case 0xEE:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xEE00000000000000uLL, Command::Kind::SETPRIMDEPTH, "G_SETPRIMDEPTH", nullptr};
+            break;
+
+          case 0xEF:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0xEF00000000000000uLL, Command::Kind::RDPSETOTHERMODE, "G_RDPSETOTHERMODE", nullptr};
+            break;
+
+          case 0xF0:
+            return OpcodeShape{true, 0x0000000007FFF000uLL, 0xF000000000000000uLL, Command::Kind::LOADTLUT, "G_LOADTLUT", &Command::LOADTLUT::problem};
+            break;
 
-        if (ap->id() == T::sid()) {
-            res = dynamic_cast<T>(ap);
+          case 0xF1:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xF100000000000000uLL, Command::Kind::RDPHALF_2, "G_RDPHALF2", nullptr};
+            break;
+
+          case 0xF2:
+            return OpcodeShape{true, 0x00FFFFFF07FFFFFFuLL, 0xF200000000000000uLL, Command::Kind::SETTILESIZE, "G_SETTILESIZE", nullptr};
+            break;
+
+          case 0xF3:
+            return OpcodeShape{true, 0x00FFFFFF07FFFFFFuLL, 0xF300000000000000uLL, Command::Kind::LOADBLOCK, "G_LOADBLOCK", nullptr};
+            break;
+
+          case 0xF4:
+            return OpcodeShape{true, 0x00FFFFFF07FFFFFFuLL, 0xF400000000000000uLL, Command::Kind::LOADTILE, "G_LOADTILE", nullptr};
+            break;
+
+          case 0xF5:
+            return OpcodeShape{true, 0x00FBFFFF07FFFFFFuLL, 0xF500000000000000uLL, Command::Kind::SETTILE, "G_SETTILE", &Command::SETTILE::problem};
+            break;
+
+          case 0xF6:
+            return OpcodeShape{true, 0x00FFFFFF00FFFFFFuLL, 0xF600000000000000uLL, Command::Kind::FILLRECT, "G_FILLRECT", &Command::FILLRECT::problem};
+            break;
+
+          case 0xF7:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xF700000000000000uLL, Command::Kind::SETFILLCOLOR, "G_SETFILLCOLOR", nullptr};
+            break;
+
+          case 0xF8:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xF800000000000000uLL, Command::Kind::SETFOGCOLOR, "G_SETFOGCOLOR", nullptr};
+            break;
+
+          case 0xF9:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xF900000000000000uLL, Command::Kind::SETBLENDCOLOR, "G_SETBLENDCOLOR", nullptr};
+            break;
+
+          case 0xFA:
+            return OpcodeShape{true, 0x0000FFFFFFFFFFFFuLL, 0xFA00000000000000uLL, Command::Kind::SETPRIMCOLOR, "G_SETPRIMCOLOR", nullptr};
+            break;
+
+          case 0xFB:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xFB00000000000000uLL, Command::Kind::SETENVCOLOR, "G_SETENVCOLOR", nullptr};
+            break;
+
+          case 0xFC:
+            return OpcodeShape{true, 0x00FFFFFFFFFFFFFFuLL, 0xFC00000000000000uLL, Command::Kind::SETCOMBINE, "G_SETCOMBINE", nullptr};
+            break;
+
+          case 0xFD:
+            return OpcodeShape{true, 0x00F80FFFFFFFFFFFuLL, 0xFD00000000000000uLL, Command::Kind::SETTIMG, "G_SETTIMG", &Command::SETTIMG::problem};
+            break;
+
+          case 0xFE:
+            return OpcodeShape{true, 0x00000000FFFFFFFFuLL, 0xFE00000000000000uLL, Command::Kind::SETZIMG, "G_SETZIMG", &Command::SETZIMG::problem};
+            break;
+
+          case 0xFF:
+            return OpcodeShape{true, 0x00F80FFFFFFFFFFFuLL, 0xFF00000000000000uLL, Command::Kind::SETCIMG, "G_SETCIMG", &Command::SETCIMG::problem};
+            break;
+        }
+
+        return OpcodeShape{false, 0, 0, Command::Kind::NOOP, nullptr, nullptr};
+    }
+
+    /** \brief The shapes of all 256 opcodes, for \c opcodeShape()
+     */
+    struct OpcodeTable {
+        OpcodeShape shapes[256];
+    };
+
+    constexpr OpcodeTable makeOpcodeTable() {
+        OpcodeTable res{};
+
+        for (size_t i = 0; i < 256; i++) {
+            res.shapes[i] = shapeOf(i);
         }
 
         return res;
     }
 
-    typedef std::deque<Command::Any *> DisplayList;
+    /** \brief Looks up the shape of an opcode, in a table made at compile
+     *         time.
+     */
+    inline const OpcodeShape & opcodeShape(uint8_t op) {
+        static constexpr OpcodeTable table = makeOpcodeTable();
+
+        return table.shapes[op];
+    }
+
+    /** \brief Checks if a word has the shape of a command.
+     *
+     *  \param[in] cmd The word to check.
+     *
+     *  \returns The shape of the command it would be, or \c nullptr if it
+     *           doesn't look like any.
+     *
+     */
+    inline const OpcodeShape * matchShape(uint64_t cmd) {
+        const OpcodeShape & shape = opcodeShape(cmd >> 56);
+
+        if (!shape.known || (cmd & ~shape.varying) != shape.fixed) {
+            return nullptr;
+        }
+
+        return &shape;
+    }
+
+    /** \brief Checks if a word is a command, and which one.
+     *
+     *  The word has to both look like a known command, and have sensible
+     *  values for that command's fields.
+     *
+     *  \param[in] cmd The word to check.
+     *
+     *  \param[out] kind The kind of command it is, if it is one.
+     *
+     *  \returns \c false if the word doesn't look like any command.
+     *
+     *  \exception X::RCP::BadCommand The word looks like a command, but has
+     *                                bad values for it.
+     *
+     */
+    bool parseOneCmd(uint64_t cmd, Command::Kind & kind);
+
+    /** \brief Checks if a word is a command, without throwing.
+     *
+     *  This is \c parseOneCmd() for when a word that isn't quite a command
+     *  isn't worth hearing about, as when searching for commands.
+     *
+     *  \param[in] cmd The word to check.
+     *
+     *  \param[out] kind The kind of command it is, if it is one.
+     *
+     *  \returns \c true if the word is a command with sensible values.
+     *
+     */
+    inline bool tryParse(uint64_t cmd, Command::Kind & kind) {
+        const OpcodeShape * shape = matchShape(cmd);
+
+        if (shape == nullptr || (shape->problem != nullptr && shape->problem(cmd) != nullptr)) {
+            return false;
+        }
 
-    // the main reason this is a separate function is to spare the template
-    // function below from being prohibitively long, which is important when it
-    // comes to template functions that get written in the header.
-    Command::Any * parseOneCmd(uint64_t cmd);
+        kind = shape->kind;
+        return true;
+    }
 
     template<typename Iter>
     std::map<size_t, DisplayList> getDLs(Iter begin, Iter end) {
         std::map<size_t, DisplayList> res;
 
+        // not even one command fits (and the search below would start before
+        // the data)
+        if (std::distance(begin, end) < 8) {
+            return res;
+        }
+
         // first we try to find the latest offset ending in 0x0 or 0x8.
         size_t starting = std::distance(begin, end) - 1;
 
@@ -745,6 +1383,14 @@ namespace RCP {
         bool indl = false;
         DisplayList dl;
 
+        // since we read backwards, commands get collected last-first in dl,
+        // and each list is copied out the right way around when it's done
+        // (which also keeps dl's space around for the next one).
+        auto finishDL = [&](size_t at) {
+            res[at] = DisplayList(dl.rbegin(), dl.rend());
+            dl.clear();
+        };
+
         /* you may be wondering why we're checking for the end iterator if we're
          * moving backwards. Simply put, we'll cheat the backward movement by
          * manually setting ptr to the end iterator after we're done with
@@ -762,36 +1408,26 @@ namespace RCP {
 
             if (mbcmd == 0xDF00000000000000uLL) {
                 if (indl) {
-                    res[std::distance(begin, ptr) + 8] = dl;
-                    dl.clear();
+                    finishDL(std::distance(begin, ptr) + 8);
                 }
 
-                dl.push_front(new Command::ENDDL(mbcmd));
+                dl.push_back(Instruction{mbcmd, Command::Kind::ENDDL});
                 indl = true;
             } else if (indl) {
                 // only do it here so we don't spend our time parsing possible
                 // commands every single iteration, even when we know it can't
-                // be done.
-                Command::Any * thecmd;
-
-                try {
-                    thecmd = parseOneCmd(mbcmd);
-                } catch (Exception & e) {
-                    std::clog << e.what() << "\n";
-                    // if an error occurs, at least for now we'll assume it
-                    // means it's actually an invalid command
-                    thecmd = nullptr;
-                }
+                // be done. Anything that isn't a proper command ends the list,
+                // bad values or not.
+                Command::Kind kind;
 
                 // we could also check if the returned command is an ENDDL, but
                 // we (hopefully!) already handled that in the first conditional
                 // above, so for now at least be lazy and don't check that.
 
-                if (thecmd != nullptr) {
-                    dl.push_front(thecmd);
+                if (tryParse(mbcmd, kind)) {
+                    dl.push_back(Instruction{mbcmd, kind});
                 } else {
-                    res[std::distance(begin, ptr) + 8] = dl;
-                    dl.clear();
+                    finishDL(std::distance(begin, ptr) + 8);
                     indl = false;
                 }
             }
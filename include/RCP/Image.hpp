@@ -42,6 +42,11 @@ namespace RCP {
 
         Format getFormat(Colors c, Size s);
 
+        /** \brief Says if \c getFormat() has a format for the given colors and
+         *         size, without throwing if not.
+         */
+        bool hasFormat(Colors c, Size s);
+
         Colors getColors(Format f);
         Size getSize(Format f);
     }
@@ -8,10 +8,18 @@
 
 #include "Config.hpp"
 #include "ConfigTree.hpp"
+#include "ROMSource.hpp"
+#include "FileCache.hpp"
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <utility>
+#include <memory>
+#include <mutex>
 #include <cstddef>
 #include <string>
 
@@ -22,6 +30,102 @@
  *
  */
 namespace ROM {
+    /** \brief The byte orders ROM dumps come in
+     */
+    enum class ByteOrder {
+        BIG,        ///< the N64's own big-endian order (usually .z64)
+        SWAPPED_16, ///< bytes swapped in each 16-bit half-word (usually .v64)
+        SWAPPED_32, ///< 32-bit words stored little-endian (usually .n64)
+    };
+
+    /** \brief Figures out the byte order of a ROM dump from its header.
+     *
+     *  Every N64 ROM starts with the same four bytes, so how those come out
+     *  tells us the order of the whole dump.
+     *
+     *  \param[in] rdata Pointer to the start of the dump.
+     *
+     *  \param[in] rsize Size of the dump.
+     *
+     *  \returns The dump's byte order, or \c ByteOrder::BIG if the header
+     *           isn't recognized.
+     *
+     */
+    ByteOrder detectByteOrder(const uint8_t * rdata, size_t rsize);
+
+    /** \brief Map from virtual addresses to file names
+     */
+    typedef std::unordered_map<uint32_t, std::string> FileNames;
+
+    /** \brief Returns the known file names in a version's config.
+     *
+     *  This collects the \c fileList group of the config (and its \c
+     *  fakeNames subgroup, for files with no official name) into a map keyed
+     *  by starting address, in one pass over each. It's built fresh from the
+     *  config it's given, so edits to the config file show up the next time
+     *  a ROM is opened.
+     *
+     *  \param[in] ct The config for the version.
+     *
+     *  \returns The map of names, empty if there's no config.
+     *
+     */
+    FileNames fileNamesFor(const ConfigTree & ct);
+
+    /** \brief The stages of opening a ROM, in the order they happen
+     */
+    enum class OpenStage {
+        MAPPING,     ///< reading or mapping the file
+        UNSWAPPING,  ///< putting the data in big-endian order
+        CACHE,       ///< looking the ROM up in the index cache
+        IDENTIFYING, ///< finding the build string, and the version from it
+        READING_TOC, ///< reading the table of contents
+        NAMING,      ///< naming the files and indexing them
+        SAVING,      ///< saving the index cache entry
+        DONE,        ///< the ROM is ready
+    };
+
+    /** \brief Follows a ROM being opened, and lets it be cancelled.
+     *
+     *  Opening a big ROM takes long enough that it's worth doing away from the
+     *  UI thread. Whoever's opening it gets told as each stage is reached, and
+     *  can cancel it from any thread; the opening stops at the next stage.
+     *
+     */
+    class OpenMonitor {
+      private:
+        std::function<void(OpenStage)> onStage; ///< Told of each stage reached
+        std::atomic<bool> cancelled;           ///< Set once cancelled
+
+      public:
+        /** \brief Constructs a monitor that's not yet cancelled.
+         *
+         *  \param[in] os Function told of each stage as it's reached. It's
+         *                called on the thread doing the opening.
+         *
+         */
+        OpenMonitor(std::function<void(OpenStage)> os = nullptr);
+
+        /** \brief Asks for the opening to stop. Safe from any thread.
+         */
+        void cancel();
+
+        /** \brief Says if \c cancel() has been called.
+         */
+        bool isCancelled() const;
+
+        /** \brief Marks the start of a stage.
+         *
+         *  \param[in] s The stage now reached.
+         *
+         *  \exception X::ROM::Cancelled The opening has been cancelled.
+         *
+         */
+        void reached(OpenStage s);
+    };
+
+    struct CachedIndex;
+
     /** \brief Class representing a TOC entry
      *
      *  This class is for representing one entry in the game's "table of
@@ -108,27 +212,51 @@ namespace ROM {
      *  by a Record. Each File comes with the Record that described it,
      *  functioning here as metadata.
      *
+     *  A File doesn't own a copy of its bytes; it's a view into a shared,
+     *  immutable buffer, usually either the ROM's own data or the result of
+     *  decompressing the file. The view keeps that buffer alive, so Files are
+     *  cheap to copy and pass around by value, and stay valid even if the ROM
+     *  they came from goes away.
+     *
      */
     class File {
       private:
-        std::vector<uint8_t> fileData; ///< raw bytes of the file
-        Record foundAt;                ///< file's Record, aka its metadata
-        bool decompressed = false;     ///< flag to avoid re-decompression attempts
+        std::shared_ptr<const uint8_t> fileData; ///< start of the file's bytes, sharing ownership of their buffer
+        size_t fileSize = 0;                     ///< number of bytes in the file
+        Record foundAt;                          ///< file's Record, aka its metadata
+        bool decompressed = false;               ///< flag to avoid re-decompression attempts
 
       public:
         File() = default;
 
         /** \brief Constructs a file from its Record and data
          *
-         *  This constructor takes a vector of bytes for the file data, and the
-         *  Record that located the file.
+         *  This constructor takes a pointer to the start of the file's data,
+         *  which also shares ownership of the buffer the data is in (see \c
+         *  std::shared_ptr's aliasing constructor), and the Record that located
+         *  the file.
+         *
+         *  \param[in] fd Pointer to the file's first byte
+         *
+         *  \param[in] fs Size of the file's data
+         *
+         *  \param[in] fa The Record that helped locate the data.
+         *
+         */
+        File(std::shared_ptr<const uint8_t> fd, size_t fs, const Record & fa);
+
+        /** \brief Constructs a file from its Record and data
+         *
+         *  This constructor takes a vector of bytes for the file data, which
+         *  the File takes over as its buffer, and the Record that located the
+         *  file.
          *
          *  \param[in] fd The raw data, as a vector of bytes
          *
          *  \param[in] fa The Record that helped locate the data.
          *
          */
-        File(const std::vector<uint8_t> & fd, const Record & fa);
+        File(std::vector<uint8_t> fd, const Record & fa);
 
         /** \brief Returns the Record for the file.
          *
@@ -143,7 +271,7 @@ namespace ROM {
         /** \brief Returns the size of the file.
          *
          *  This function indicates the size of the file in bytes, effectively
-         *  the size of the raw data vector. Note that its correspondence to \c
+         *  the size of the raw data. Note that its correspondence to \c
          *  Record::psize() or \c Record::vsize() depends on whether the file
          *  was compressed originally, and if so if it's a decompressed version
          *  of the file.
@@ -160,8 +288,8 @@ namespace ROM {
         /** \brief Returns the byte at the given index.
          *
          *  This function returns the byte at the specified index in the raw
-         *  data. It uses the vector's \c at() function internally, so
-         *  out-of-bounds accesses are checked for and will cause an exception.
+         *  data. Out-of-bounds accesses are checked for and will cause an
+         *  exception (\c std::out_of_range, like \c std::vector::at() would).
          *
          *  \param[in] idx Index into the raw data
          *
@@ -175,7 +303,7 @@ namespace ROM {
          *  This member function decompresses the File it's called on, and
          *  returns a \em new \c File as a result. If the file is already
          *  decompressed, or was never compressed to begin with, returns a \em
-         *  copy of itself.
+         *  copy of itself (which, Files being views, doesn't copy any data).
          *
          *  \warning Due to the likely chance that you may think otherwise, this
          *           function <b>does not</b> modify itself; the decompressed
@@ -198,34 +326,59 @@ namespace ROM {
         [[nodiscard]] File decompress() const;
 #endif
 
+        /** \brief Returns the first bytes of the file's contents.
+         *
+         *  For compressed files, this decompresses just enough of the file to
+         *  get the bytes asked for, which makes it far cheaper than \c
+         *  decompress() when all you want is a look at the start of a file
+         *  (to tell what kind of file it is, say). Uncompressed files simply
+         *  have their first bytes copied.
+         *
+         *  \param[in] count Most bytes to return.
+         *
+         *  \returns Up to \c count bytes from the start of the file, fewer if
+         *           the file is smaller than that.
+         *
+         *  \exception X::Yaz0::Decompress The file's compressed data is
+         *                                 malformed.
+         *
+         */
+        std::vector<uint8_t> peek(size_t count) const;
+
         /** \brief Returns a copy of the file's data as-is.
          *
          *  This function returns a copy of the vector of bytes constituting the
          *  file's raw data. If the file is currently compressed, you will get
          *  back a compressed vector.
          *
+         *  Since this copies the whole file, prefer \c data() or \c begin()
+         *  and \c end() when you only need to read the data.
+         *
          *  \returns a \c std::vector<uint8_t> containing the file's data.
          *
          */
         std::vector<uint8_t> getData() const;
 
-        /** \brief Returns an iterator to the beginning of the data.
+        /** \brief Returns a pointer to the file's data.
          *
-         *  This is just "forwarding" the internal vector's begin iterator.
+         *  \returns Pointer to the first byte of the file.
          *
-         *  \returns Vector iterator
+         */
+        const uint8_t * data() const;
+
+        /** \brief Returns an iterator to the beginning of the data.
+         *
+         *  \returns Pointer to the first byte of the file.
          *
          */
-        std::vector<uint8_t>::iterator begin();
+        const uint8_t * begin() const;
 
         /** \brief Returns an iterator to one-past-the-end of the data.
          *
-         *  THis just "forwards" the internal vector's end iterator.
-         *
-         *  \returns Vector iterator
+         *  \returns Pointer just past the last byte of the file.
          *
          */
-        std::vector<uint8_t>::iterator end();
+        const uint8_t * end() const;
     };
 
     /** \brief Class for a ROM file
@@ -235,29 +388,47 @@ namespace ROM {
      *  construction, and loads individual files on demand. (It also memoizes
      *  these file loads so future accesses aren't so time-consuming.)
      *
-     *  Since this class currently loads the entirety of ROM into memory, it's
-     *  currently recommended that you don't copy ROM objects, but rather pass
-     *  around pointers or references. (Memory mapping files is being considered
-     *  for the future.)
+     *  Once constructed, a ROM can be read from multiple threads at once;
+     *  loading files (and filling the file caches) is thread-safe.
+     *
+     *  The ROM's data comes from a Source, which for ROMs opened from a file
+     *  is a memory mapping of that file. Copying ROM objects is still not
+     *  recommended however, pass around pointers or references instead.
      *
      */
     class ROM {
       private:
-        std::vector<uint8_t> rawData;          ///< Raw file data
+        std::shared_ptr<Source> rawData;       ///< Raw file data
         std::vector<Record> fileList;          ///< List of extracted TOC entries
-        mutable std::map<size_t, File> fcache; ///< cache of files that have been previously requested
-        mutable std::map<size_t, File> decfcache; ///< cache of decompressed files
+        std::unordered_map<uint32_t, size_t> vstartIndex; ///< fileList index for each starting address
+        std::unordered_map<std::string, size_t> nameIndex; ///< fileList index for each known name
+        std::vector<std::pair<uint32_t, size_t>> rangeIndex; ///< (vstart, fileList index) of non-empty files, sorted
+        mutable FileCache decfcache;           ///< cache of decompressed files
 
         Config::Version rver; ///< Programmatically determined ROM version
         ConfigTree ctree;     ///< Config data for data hard/impossible to get out of ROM currently
 
-        bool wasBS = false;   ///< Indicates if the ROM was originally byteswapped
+        ByteOrder origOrder = ByteOrder::BIG; ///< The byte order the ROM originally had
+
+        size_t tocOffset = 0; ///< Where in the ROM the TOC file starts
+
+        mutable std::once_flag crcDone;                  ///< set once \c crcResult is filled in
+        mutable std::pair<uint32_t, uint32_t> crcResult; ///< calculated CRC values
+        mutable std::once_flag hashesDone;               ///< set once \c fileHashes is filled in
+        mutable std::vector<uint64_t> fileHashes;        ///< hash of each file's data, in TOC order
 
         /** \brief Private function for handling file caching
          *
          *  This function takes the record of a file to retrieve, and if it
          *  isn't cached yet does so. It then returns the file in question.
          *
+         *  Files as they are in the ROM are just views of the ROM's data, so
+         *  those aren't cached at all. Only decompressed files are, and those
+         *  share their one decompressed buffer, so no file data gets copied by
+         *  this.
+         *
+         *  This is safe to call from multiple threads at once; see FileCache.
+         *
          *  \param[in] r The file's record.
          *
          *  \param[in] autodecomp Indicates if the file should be automatically
@@ -268,13 +439,27 @@ namespace ROM {
          */
         File cachedAccess(const Record & r, bool autodecomp) const;
 
+        /** \brief Private function for finding the build string
+         *
+         *  This looks for "zelda@" at the places it's known to be for each
+         *  supported version first, and only scans the whole ROM if it isn't
+         *  in any of them.
+         *
+         *  \returns Pointer to the start of the string in the ROM data, or \c
+         *           nullptr if it couldn't be found.
+         *
+         */
+        const uint8_t * findMagic() const;
+
         /** \brief Private function for un-byteswapping ROMs
          *
-         *  This function de-byteswaps the raw data if need be. It does _not_
-         *  set the wasBS variable.
+         *  This function puts the raw data into big-endian order, from the
+         *  given byte order. It does _not_ set the origOrder variable.
+         *
+         *  \param[in] from The byte order the data is in now.
          *
          */
-        void unByteSwap();
+        void unByteSwap(ByteOrder from);
 
         /** \brief Handles extracting info from the Table of Contents
          *
@@ -292,6 +477,39 @@ namespace ROM {
          */
         void bootstrapTOC(size_t firstEntry);
 
+        /** \brief Private function for naming the files
+         *
+         *  Gives each record the name the config has for its address, if any,
+         *  and then builds the lookup indexes.
+         *
+         */
+        void nameFiles();
+
+        /** \brief Private function for building the lookup indexes
+         *
+         *  Builds the indexes used to find records by address and name, from
+         *  the finished fileList. Where several records share an address or
+         *  name, the first one in the TOC wins.
+         *
+         */
+        void buildIndexes();
+
+        /** \brief Private function for taking on a cached index
+         *
+         *  Sets the ROM up from what the index cache had stored for it,
+         *  instead of working it all out again.
+         *
+         *  The entry is only taken on if its TOC fits in the data and the
+         *  data up to the TOC's end hashes the same as when it was saved.
+         *
+         *  \param[in] idx The cached index, looked up by this ROM's size and
+         *                 header CRCs.
+         *
+         *  \returns \c true if the index could be used.
+         *
+         */
+        bool adoptIndex(CachedIndex & idx);
+
         /** \brief Handles reading the timestamp in the file for figuring out
          *         the version.
          *
@@ -310,12 +528,54 @@ namespace ROM {
          */
         void bootstrapCompTime(size_t strat);
 
+        /** \brief Calculates the CRC values for any ROM data.
+         *
+         *  This is the actual CRC algorithm behind \c calcCRC(), split out so
+         *  it can be used on ROM images we build ourselves.
+         *
+         *  \param[in] rdata Pointer to the start of the ROM data, which must
+         *                   be at least \c 0x101000 bytes long.
+         *
+         *  \returns The resulting two CRC values.
+         *
+         */
+        static std::pair<uint32_t, uint32_t> calcCRCOf(const uint8_t * rdata);
+
       public:
         /** \brief Constructor for ROM object
          *
-         *  Takes the raw data of a file and sets itself up to handle the ROM,
-         *  assuming it's a proper Zelda ROM. Exceptions can be thrown if the
-         *  file is in some way invalid.
+         *  Takes the source of a ROM's data and sets itself up to handle the
+         *  ROM, assuming it's a proper Zelda ROM. Exceptions can be thrown if
+         *  the file is in some way invalid.
+         *
+         *  Only the parts of the ROM needed to identify it and read its table
+         *  of contents are looked at here, so for a memory-mapped Source this
+         *  doesn't need to read the whole file. (The exception is byteswapped
+         *  ROMs, which first have to be copied so they can be un-swapped.)
+         *
+         *  If given a cache directory, the ROM is first looked up in the index
+         *  cache kept there (see \c IndexCache), which costs one small file
+         *  read and a hash of the ROM's start, up to the end of its TOC; if
+         *  it's there, nothing else needs working out. Otherwise the ROM is examined as usual, and the
+         *  results saved to the cache for next time.
+         *
+         *  \param[in] src The Source of the ROM's data.
+         *
+         *  \param[in] indexDir Directory of the index cache, or empty to not
+         *                      use one.
+         *
+         *  \param[in] mon Told of each stage of the opening, and checked for
+         *                 cancelling between them, if given.
+         *
+         *  \exception X::ROM::Cancelled \c mon was cancelled.
+         *
+         */
+        ROM(std::shared_ptr<Source> src, const std::string & indexDir = "", OpenMonitor * mon = nullptr);
+
+        /** \brief Constructor for ROM object from a vector of bytes
+         *
+         *  Convenience constructor for when the data is already in memory; the
+         *  vector is handed to a new Source.
          *
          *  \param[in] rfile A vector of bytes from the file in question.
          *
@@ -333,6 +593,13 @@ namespace ROM {
          */
         bool wasByteswapped() const;
 
+        /** \brief Returns the byte order the ROM was originally in
+         *
+         *  \returns The original byte order of the file handed to this ROM.
+         *
+         */
+        ByteOrder originalByteOrder() const;
+
         /** \brief Indicates the number of files in the ROM
          *
          *  This function simply returns the number of files that were in the
@@ -424,7 +691,8 @@ namespace ROM {
         /** \brief Returns the Record for the nth TOC entry.
          *
          *  This returns just the record as extracted from TOC, by index into
-         *  that TOC.
+         *  that TOC. The record isn't copied, and the reference stays good for
+         *  as long as the ROM does.
          *
          *  \param[in] idx Index into the TOC list.
          *
@@ -434,7 +702,7 @@ namespace ROM {
          *                               files.
          *
          */
-        Record recordAtNum(size_t idx) const;
+        const Record & recordAtNum(size_t idx) const;
 
         /** \brief Returns the Record for the given starting address
          *
@@ -469,6 +737,23 @@ namespace ROM {
          */
         Record recordAtName(std::string name) const;
 
+        /** \brief Returns the Record for the file containing the given address
+         *
+         *  Unlike \c recordAtVAddress(), the address can be anywhere inside
+         *  the file, which is what's needed to figure out where a pointer
+         *  from one file into another is pointing. Files with a virtual size
+         *  of zero never contain anything.
+         *
+         *  \param[in] addr Any virtual address.
+         *
+         *  \returns The record of the file whose virtual range includes the
+         *           address.
+         *
+         *  \exception X::BadIndex No file contains the given address.
+         *
+         */
+        Record recordContainingVAddress(size_t addr) const;
+
         /** \brief The size of the ROM file.
          *
          *  This returns the size of the ROM's data as it was passed in, in
@@ -602,10 +887,67 @@ namespace ROM {
          *  \returns A \c CRCPair holding the resulting two CRC values, in the
          *           order they would be in the header.
          *
-         *  Thanks to Zoinkity for the Python implementation from which this
-         *  implementation was adapted.
+         *  The work is done by \c CRCState, which can also keep the values up
+         *  to date through later edits to the data. The result is remembered,
+         *  so only the first call takes any time.
          *
          */
         CRCPair calcCRC() const;
+
+        /** \brief Returns a hash of each file's data.
+         *
+         *  The hashes (from \c hash64()) are of the files as they're stored
+         *  in the ROM, so compressed files are hashed compressed; missing
+         *  files, and ones whose records don't fit in the ROM, hash as empty.
+         *  They're in the same order as the TOC.
+         *
+         *  These get worked out (in parallel) on the first call.
+         *
+         *  \returns The hashes, one per file.
+         *
+         */
+        const std::vector<uint64_t> & rawFileHashes() const;
+
+        /** \brief Sets how much memory decompressed files may take up.
+         *
+         *  Decompressed files are cached, up to this many bytes' worth; past
+         *  that, the least recently used ones are dropped (and decompressed
+         *  again if needed later). Files already handed out aren't affected.
+         *
+         *  \param[in] bytes Budget in bytes for the decompressed file cache.
+         *
+         */
+        void setCacheBudget(size_t bytes);
+
+        /** \brief Returns the counters of the decompressed file cache.
+         *
+         *  \returns Hits, misses, evictions, and current size of the cache.
+         *
+         */
+        FileCache::Stats cacheStats() const;
+
+        /** \brief Builds a fully decompressed image of this ROM.
+         *
+         *  This decompresses every compressed file (in parallel, across all
+         *  cores) and lays every file out at its virtual address, which is the
+         *  usual "decompressed ROM" other tools expect. The TOC in the new
+         *  image is rewritten to match, with each file's physical address
+         *  being its virtual one and no file marked as compressed. Missing
+         *  files stay missing, and their space is left zeroed, as are any gaps
+         *  between files; besides the files, only the header and boot code
+         *  and the build string before the TOC are copied over.
+         *
+         *  The image is padded with zeros up to the next power of two in size,
+         *  and its header gets the correct CRC values for the new contents.
+         *
+         *  \returns The decompressed ROM image.
+         *
+         *  \exception X::Yaz0::Decompress A file failed to decompress.
+         *
+         *  \exception X::BadROM A file's record doesn't fit in the ROM, or the
+         *                       TOC's own record is missing or doesn't fit.
+         *
+         */
+        std::vector<uint8_t> decompressedImage() const;
     };
 }
\ No newline at end of file
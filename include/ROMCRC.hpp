@@ -0,0 +1,111 @@
+/** \file ROMCRC.hpp
+ *
+ *  \brief Declares the class calculating (and recalculating) ROM CRCs.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ROM {
+    /** \brief Class calculating the header CRC values of a ROM
+     *
+     *  The CRC covers the megabyte of ROM from \c 0x1000 to \c 0x101000 (with
+     *  help from 256 bytes at \c 0x750), which it goes through one 32-bit word
+     *  at a time feeding six running values. Five of those are just sums or
+     *  XORs of something about each word, but the fifth register depends on
+     *  its own previous value and on the running sum, so it has to be worked
+     *  out in order.
+     *
+     *  The data is handled in chunks of 64 words, the length of the extra
+     *  data at \c 0x750, so each word in a chunk lines up with the same extra
+     *  word every time and there's no index math per word. For each chunk we
+     *  remember its contribution to the order-independent values, and the
+     *  state of the order-dependent ones as it starts.
+     *
+     *  That makes updates after editing a range of bytes cheaper: the edited
+     *  chunks get their contributions redone, and only the order-dependent
+     *  register is run forward from the first edited chunk to the end (or
+     *  until it happens to fall back into its old state). That one register
+     *  is also the cheapest part of the calculation, so an update costs well
+     *  under a full pass even for edits near the start.
+     *
+     */
+    class CRCState {
+      public:
+        static const size_t START = 0x1000;   ///< first byte covered by the CRC
+        static const size_t END   = 0x101000; ///< one past the last byte covered
+
+      private:
+        static const size_t CHUNK_WORDS = 64;                ///< words per chunk
+        static const size_t CHUNK_SIZE  = CHUNK_WORDS * 4;   ///< bytes per chunk
+        static const size_t EXTRA_START = 0x750;             ///< where the extra data is
+
+        /** \brief What we know about one chunk of the data
+         */
+        struct Chunk {
+            uint64_t sum;     ///< sum of the words, without wrapping
+            uint32_t xors;    ///< XOR of the words
+            uint32_t rots;    ///< sum of each word rotated by itself
+            uint32_t extras;  ///< sum of each word XORed with its extra word
+            uint32_t reg0In;  ///< running sum (low 32 bits) as this chunk starts
+            uint32_t reg4In;  ///< order-dependent register as this chunk starts
+        };
+
+        std::array<uint32_t, CHUNK_WORDS> extra; ///< the extra data at \c 0x750
+        std::vector<Chunk> chunks;               ///< every chunk of the covered data
+
+        uint64_t sum;    ///< total sum of the words, plus seed
+        uint32_t xors;   ///< register 2
+        uint32_t rots;   ///< register 3
+        uint32_t reg4;   ///< register 4
+        uint32_t extras; ///< register 5
+
+        /** \brief Goes through one chunk of data.
+         *
+         *  Runs the order-dependent register across the chunk, and if \c
+         *  Parts is \c true also works out the chunk's contributions to the
+         *  other registers.
+         *
+         */
+        template<bool Parts>
+        void runChunk(const uint8_t * words, Chunk & ch, uint32_t & reg0, uint32_t & r4) const;
+
+        /** \brief Calculates everything from scratch.
+         */
+        void recalc(const uint8_t * rdata);
+
+      public:
+        /** \brief Calculates the CRC of the given ROM data.
+         *
+         *  \param[in] rdata Pointer to the start of the ROM data, which must
+         *                   be at least \c END bytes long.
+         *
+         */
+        CRCState(const uint8_t * rdata);
+
+        /** \brief Brings the CRC up to date after some bytes were changed.
+         *
+         *  \param[in] rdata Pointer to the start of the ROM data, as it is
+         *                   after the change.
+         *
+         *  \param[in] start First byte that changed.
+         *
+         *  \param[in] end One past the last byte that changed.
+         *
+         */
+        void update(const uint8_t * rdata, size_t start, size_t end);
+
+        /** \brief Returns the two CRC values.
+         *
+         *  \returns The CRC values, in the order they go in the header.
+         *
+         */
+        std::pair<uint32_t, uint32_t> result() const;
+    };
+}
\ No newline at end of file
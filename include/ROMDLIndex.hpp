@@ -0,0 +1,139 @@
+/** \file ROMDLIndex.hpp
+ *
+ *  \brief Declares the index of display lists found across a whole ROM.
+ *
+ */
+
+#pragma once
+
+#include "ROM.hpp"
+#include "RCP/DisplayList.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ROM {
+    /** \brief The kinds of files that hold models, going by their names
+     */
+    enum class ModelFile {
+        NONE,   ///< not a model file (or one we can't tell, having no name)
+        OBJECT, ///< \c object_*, or the \c gameplay_* keep files
+        SCENE,  ///< \c *_scene in Ocarina of Time, or a \c Z2_* scene in Majora's Mask
+        ROOM,   ///< \c *_room_* in either game
+    };
+
+    /** \brief Works out what kind of model file a file is, by its name.
+     *
+     *  \param[in] fname The file's name, from the config file.
+     *
+     *  \returns The kind of file, or \c ModelFile::NONE.
+     *
+     */
+    ModelFile modelFileKind(const std::string & fname);
+
+    /** \brief How many commands of one kind a display list has
+     */
+    struct KindCount {
+        RCP::Command::Kind kind; ///< The kind of command
+        uint32_t count;          ///< How many there are
+    };
+
+    /** \brief One display list found in a file
+     */
+    struct DLEntry {
+        size_t file;     ///< Index of the file in the ROM's TOC
+        uint32_t offset; ///< Where the list starts in the (decompressed) file
+        uint32_t length; ///< How many commands it has, counting the \c G_ENDDL
+
+        std::vector<KindCount> histogram; ///< How many of each kind of command it has, in \c Kind order, leaving out kinds it has none of
+    };
+
+    /** \brief Every display list found in a set of a ROM's files
+     */
+    struct DLIndex {
+        uint64_t sourceHash = 0; ///< \c dlSourceHash() of the files scanned
+
+        std::vector<size_t> files;  ///< TOC indexes of the files scanned, in order
+        std::vector<size_t> failed; ///< TOC indexes of the files that couldn't be read or decompressed
+
+        std::vector<DLEntry> lists; ///< The lists found, sorted by file and then offset
+
+        /** \brief Returns the lists found in one file.
+         *
+         *  \param[in] file The file's index in the TOC.
+         *
+         *  \returns The range of \c lists in that file, empty if none.
+         *
+         */
+        std::pair<std::vector<DLEntry>::const_iterator, std::vector<DLEntry>::const_iterator>
+        inFile(size_t file) const;
+    };
+
+    /** \brief Returns the TOC indexes of a ROM's model files.
+     *
+     *  These are the non-empty files \c modelFileKind() says are objects,
+     *  scenes or rooms. Without a config file for the ROM's version there are
+     *  no names, and so no model files.
+     *
+     *  \param[in] rom The ROM.
+     *
+     *  \returns The indexes, in TOC order.
+     *
+     */
+    std::vector<size_t> modelFiles(const ROM & rom);
+
+    /** \brief Hashes what a DL index of some files depends on.
+     *
+     *  That's which files they are, and their \c ROM::rawFileHashes(), so a
+     *  cached index can be checked without decompressing anything.
+     *
+     *  \param[in] rom The ROM.
+     *
+     *  \param[in] files TOC indexes of the files.
+     *
+     *  \returns The hash.
+     *
+     */
+    uint64_t dlSourceHash(const ROM & rom, const std::vector<size_t> & files);
+
+    /** \brief Finds every display list in some of a ROM's files, in parallel.
+     *
+     *  Each file is decompressed if needed (going around the ROM's file
+     *  cache, which scanning every model file would only flush) and searched
+     *  with \c RCP::getDLs(), with the files spread across Qt's global thread
+     *  pool. Larger files are handed out first, so one big scene doesn't end
+     *  up running alone at the end.
+     *
+     *  Files that fail to decompress, or whose records don't fit the ROM, are
+     *  listed in \c DLIndex::failed rather than stopping the whole scan.
+     *
+     *  \param[in] rom The ROM.
+     *
+     *  \param[in] files TOC indexes of the files to scan.
+     *
+     *  \returns The index.
+     *
+     */
+    DLIndex scanDLs(const ROM & rom, const std::vector<size_t> & files);
+
+    /** \brief Returns the display lists of all of a ROM's model files,
+     *         cached.
+     *
+     *  This is \c scanDLs() of \c modelFiles(), except that if an index
+     *  cache directory is given, the result is saved there and used again
+     *  the next time, as long as the files still hash the same (see \c
+     *  IndexCache::loadDLs()).
+     *
+     *  \param[in] rom The ROM.
+     *
+     *  \param[in] indexDir Directory of the index cache, or empty to not use
+     *                      one.
+     *
+     *  \returns The index.
+     *
+     */
+    DLIndex modelDLIndex(const ROM & rom, const std::string & indexDir = "");
+}
\ No newline at end of file
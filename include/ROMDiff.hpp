@@ -0,0 +1,144 @@
+/** \file ROMDiff.hpp
+ *
+ *  \brief Declares functions for comparing the files of two ROMs.
+ *
+ */
+
+#pragma once
+
+#include "ROM.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace ROM {
+    /** \brief Hashes the contents of a file.
+     *
+     *  Compressed files are decompressed first, so two files with the same
+     *  contents hash the same however they're stored. Missing files hash as
+     *  empty.
+     *
+     *  \param[in] rf The file, as it is in the ROM.
+     *
+     *  \returns The \c hash64() of the file's contents.
+     *
+     *  \exception X::Yaz0::Decompress The file failed to decompress.
+     *
+     */
+    uint64_t fileContentHash(const File & rf);
+
+    /** \brief Hashes the contents of every file in a ROM, in parallel.
+     *
+     *  Every file is decompressed for this (without going through the ROM's
+     *  file cache, which it would only flush), so it's a good deal slower
+     *  than \c ROM::rawFileHashes(); use that one if you only need to know
+     *  whether files are stored identically.
+     *
+     *  \param[in] rom The ROM.
+     *
+     *  \returns The \c fileContentHash() of each file, in TOC order.
+     *
+     *  \exception X::Yaz0::Decompress A file failed to decompress.
+     *
+     */
+    std::vector<uint64_t> fileContentHashes(const ROM & rom);
+
+    /** \brief A stretch of bytes that differs between two versions of a file
+     *
+     *  Both ranges are half-open, like \c Record addresses. For files of the
+     *  same size the two ranges are the same; otherwise they can differ in
+     *  length, one of them even being empty for bytes that were only added or
+     *  removed.
+     *
+     */
+    struct ByteRange {
+        size_t oldStart; ///< Start of the range in the old file
+        size_t oldEnd;   ///< One-past-the-end of the range in the old file
+        size_t newStart; ///< Start of the range in the new file
+        size_t newEnd;   ///< One-past-the-end of the range in the new file
+    };
+
+    /** \brief How one file compares between two ROMs
+     */
+    struct FileDiff {
+        /** \brief The kinds of differences a file can have
+         */
+        enum class Change {
+            SAME,     ///< stored exactly the same (though possibly somewhere else)
+            REPACKED, ///< same contents, but compressed differently
+            CHANGED,  ///< different contents
+            ADDED,    ///< only in the new ROM
+            REMOVED,  ///< only in the old ROM
+        };
+
+        Change change; ///< How the file differs
+
+        Record oldRec; ///< The file's record in the old ROM, unless \c ADDED
+        Record newRec; ///< The file's record in the new ROM, unless \c REMOVED
+
+        size_t oldSize = 0; ///< Size of the old file's contents, for \c CHANGED files
+        size_t newSize = 0; ///< Size of the new file's contents, for \c CHANGED files
+
+        std::vector<ByteRange> ranges; ///< Where the contents differ, for \c CHANGED files
+    };
+
+    /** \brief The result of comparing two ROMs
+     */
+    struct ROMDiff {
+        std::vector<FileDiff> files; ///< Every file of either ROM, in the old ROM's TOC order, then added files
+
+        /** \brief Returns how many files had a given kind of difference.
+         */
+        size_t count(FileDiff::Change which) const;
+    };
+
+    /** \brief Compares the files of two ROMs.
+     *
+     *  Files are paired up by their starting virtual address first, and the
+     *  ones left over by name. Empty records (like the zeroed entries padding
+     *  out the TOC) are ignored.
+     *
+     *  Since most files of a modified ROM are usually untouched, files are
+     *  first compared by their \c ROM::rawFileHashes() (which may well come
+     *  from the index cache); only pairs stored differently get decompressed,
+     *  which happens in parallel. Those whose contents turn out the same are
+     *  \c REPACKED, and the rest get the ranges of bytes that differ worked
+     *  out.
+     *
+     *  For files that kept their size, every differing stretch of bytes gets
+     *  its own range (stretches less than \c MERGE_GAP bytes apart are merged
+     *  into one). For files that changed size, there's one range covering
+     *  everything between their common start and common end.
+     *
+     *  \param[in] older The ROM to compare against, like an unmodified one.
+     *
+     *  \param[in] newer The ROM to compare.
+     *
+     *  \returns The differences.
+     *
+     *  \exception X::Yaz0::Decompress A file failed to decompress.
+     *
+     */
+    ROMDiff diffROMs(const ROM & older, const ROM & newer);
+
+    /** \brief Closest two differing stretches of bytes can be without \c
+     *         diffROMs() merging them
+     */
+    const size_t MERGE_GAP = 16;
+
+    /** \brief Writes a human-readable report of a ROM comparison.
+     *
+     *  Identical files are only counted, the others are listed one per line
+     *  with their byte ranges below them.
+     *
+     *  \param[in] out Where to write the report.
+     *
+     *  \param[in] diff The comparison.
+     *
+     *  \param[in] maxRanges Most byte ranges to list per file.
+     *
+     */
+    void writeDiffReport(std::ostream & out, const ROMDiff & diff, size_t maxRanges = 16);
+}
\ No newline at end of file
@@ -10,13 +10,45 @@
 #include "ROM.hpp"
 
 #include <QAbstractTableModel>
+#include <QIcon>
+#include <QString>
 
+#include <cstdint>
+#include <vector>
+
+/** \brief Table model of a ROM's files
+ *
+ *  Views ask for the same few cells over and over while scrolling, so
+ *  everything shown is worked out once when the model is made (or reset), and
+ *  \c data() only hands out copies of the shared strings.
+ *
+ */
 class ROMFileModel : public QAbstractTableModel {
     Q_OBJECT
 
   private:
+    /** \brief The icon shown next to a file's name
+     */
+    enum class Decoration : uint8_t {
+        NONE,
+        COMPRESSED,
+        MISSING,
+    };
+
     ROM::ROM * data_src;
 
+    std::vector<QString> names;          ///< Display text of the name column
+    std::vector<QString> vlocs;          ///< Display text of the location column
+    std::vector<QString> sizes;          ///< Display text of the size column
+    std::vector<Decoration> decorations; ///< Icon for each name
+
+    QIcon compressed_icon; ///< Shown for compressed files
+    QIcon missing_icon;    ///< Shown for missing files
+
+    /** \brief Fills in the display text and icons for every file.
+     */
+    void buildCache();
+
   public:
     ROMFileModel(ROM::ROM * ds);
 
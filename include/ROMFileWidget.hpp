@@ -42,6 +42,8 @@ class ROMFileWidget : public QWidget {
     QLabel * comp_val;
     QLabel * empty_key;
     QLabel * empty_val;
+    QLabel * head_key;
+    QLabel * head_val;
 
     QCheckBox * want_dec;
 
@@ -0,0 +1,93 @@
+/** \file ROMGen.hpp
+ *
+ *  \brief Declares the generator of synthetic ROM images.
+ *
+ */
+
+#pragma once
+
+#include "ROM.hpp"
+#include "Config.hpp"
+#include "yaz0.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ROM {
+    /** \brief What kind of ROM image \c generate() should make
+     */
+    struct GenOptions {
+        Config::Version version = Config::Version::OOT_NTSC_1_0; ///< Version to look like, for the build timestamp and header
+
+        size_t files = 1500;          ///< Number of files, besides makerom, boot and dmadata
+        size_t minFileSize = 0x100;   ///< Smallest size of a file
+        size_t maxFileSize = 0x20000; ///< Largest size of a file
+
+        double compressed = 0.0; ///< Fraction of the files to store Yaz0-compressed
+        double missing = 0.0;    ///< Fraction of the files to list as missing
+
+        Yaz0Level level = Yaz0Level::FAST; ///< How hard to compress the compressed files
+
+        size_t tocOffset = 0; ///< Where to put the TOC, or 0 for where \c version has it
+        size_t minSize = 0;   ///< Smallest size of the image
+
+        ByteOrder order = ByteOrder::BIG; ///< Byte order to write the image in
+
+        uint32_t seed = 1; ///< Seed for the file sizes, kinds and contents
+    };
+
+    /** \brief A generated ROM image
+     */
+    struct Generated {
+        std::vector<uint8_t> data;   ///< The image
+        std::vector<Record> records; ///< The TOC written into it (without names), for checking what's read back
+    };
+
+    /** \brief Makes a ROM image that opens like a real one.
+     *
+     *  Nobody can share dumps of the games, so this makes images with the
+     *  same structure for testing and benchmarking: a header with the right
+     *  name, code and CRC values, the build string and compile timestamp of
+     *  the chosen version, and a TOC (dmadata) listing itself after makerom
+     *  and boot, then the requested files.
+     *
+     *  File sizes are picked evenly between the minimum and maximum (rounded
+     *  to 16 bytes), and their contents are made to compress roughly like real
+     *  game data. The virtual addresses are laid out one after another, as
+     *  are the physical ones; missing files take up virtual space only, and
+     *  compressed ones only as much physical space as they need. When no files
+     *  are compressed or missing, every file's physical and virtual addresses
+     *  are the same, like in a decompressed ROM.
+     *
+     *  The image is padded with zeros to a power of two, at least \c
+     *  minSize. The same options always make the same image, and the file
+     *  contents are made (and compressed) in parallel.
+     *
+     *  \param[in] opts What to make.
+     *
+     *  \returns The image, and the TOC in it.
+     *
+     *  \exception X::ROM::GenError The options don't make sense, or the
+     *                              image wouldn't fit 32-bit addresses.
+     *
+     */
+    Generated generate(const GenOptions & opts);
+
+    /** \brief Returns the options for an image with 10,000 files.
+     *
+     *  That's several times what the games have, half of them compressed and
+     *  a few missing, for stressing TOC reading and the lookup indexes.
+     *
+     */
+    GenOptions manyFilesShape();
+
+    /** \brief Returns the options for a 256 MiB image.
+     *
+     *  Four times the largest real ROM, with a quarter of the files
+     *  compressed, for stressing the whole-ROM passes (hashing, CRCs,
+     *  searches) and the file cache.
+     *
+     */
+    GenOptions hugeImageShape();
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+/** \file ROMIndexCache.hpp
+ *
+ *  \brief Declares the on-disk cache of what ROMs were found to contain.
+ *
+ */
+
+#pragma once
+
+#include "ROM.hpp"
+#include "ROMDLIndex.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ROM {
+    /** \brief Everything worked out about a ROM when it was opened
+     *
+     *  This is what the index cache stores for a ROM: the results of
+     *  identifying it and reading its TOC, so that opening the same ROM again
+     *  can skip all of it. Things that take a pass over the whole ROM (like
+     *  the calculated CRC, or the hashes of each file) aren't kept, since
+     *  checking they still fit would take a pass just as long; those are
+     *  worked out when first asked for, as usual.
+     *
+     */
+    struct CachedIndex {
+        uint64_t romSize = 0;  ///< Size of the ROM data
+        uint64_t headHash = 0; ///< \c hash64() of the ROM data up to \c tocEnd(), in big-endian order
+        std::pair<uint32_t, uint32_t> headerCRC; ///< CRC values stored in the header
+
+        ByteOrder origOrder = ByteOrder::BIG; ///< Byte order the ROM was found to be in
+        Config::Version rver = Config::Version::UNKNOWN; ///< The ROM's version
+        uint64_t configStamp = 0; ///< \c configStamp() of the version's config file when the names were read
+
+        size_t tocOffset = 0; ///< Where in the ROM the TOC file starts
+
+        std::vector<Record> fileList; ///< The TOC's records, with their names
+    };
+
+    /** \brief Returns where a ROM's TOC ends.
+     *
+     *  Everything the index cache keeps for a ROM comes from its data up to
+     *  there (the header, the build string, and the TOC), so a hash of just
+     *  that much is enough to tell if an entry still fits, and opening a known
+     *  ROM still only reads the start of it.
+     *
+     *  \param[in] files The ROM's TOC records.
+     *
+     *  \param[in] tocOffset Where the TOC starts.
+     *
+     *  \param[in] romSize Size of the ROM data.
+     *
+     *  \returns The offset just past the TOC, or \c 0 if there's no record for
+     *           a TOC at \c tocOffset, or it doesn't fit in the ROM.
+     *
+     */
+    size_t tocEnd(const std::vector<Record> & files, size_t tocOffset, size_t romSize);
+
+    /** \brief Returns a value that changes whenever a version's config file
+     *         does.
+     *
+     *  File names come from the config file, so a cached index made before
+     *  that file was edited (or installed) has to be thrown out. This
+     *  combines the file's path, size and modification time, which is cheap
+     *  to get and changes with any edit.
+     *
+     *  \param[in] ver The version whose config file to look at.
+     *
+     *  \returns The stamp, which is \c 0 when there's no config file.
+     *
+     */
+    uint64_t configStamp(Config::Version ver);
+
+    /** \brief Returns the usual directory for the index cache.
+     *
+     *  This is \c romindex in the application's cache directory (as given by
+     *  \c QStandardPaths), which gets created if need be. It's shared by
+     *  everything opening ROMs, so the application name needs to be set
+     *  before calling this.
+     *
+     *  \returns The directory, or an empty string if it couldn't be made.
+     *
+     */
+    std::string defaultIndexDir();
+
+    /** \brief Class for reading and writing cached ROM indexes
+     *
+     *  Each ROM gets one small file in the cache directory, named after the
+     *  header CRC values and the ROM's size, so finding the entry for a ROM
+     *  takes nothing more than its header. Since hacks often don't bother
+     *  fixing the CRC, the entry also holds a hash of the ROM's data up to
+     *  the end of its TOC, which has to match before the entry is used.
+     *
+     *  An entry is ignored (and replaced the next time it's saved) if
+     *
+     *  - it isn't a cache file of the current \c FORMAT_VERSION,
+     *  - it's damaged or cut short,
+     *  - the ROM's size or header CRC don't match it,
+     *  - its TOC doesn't fit the ROM, or the data up to the TOC's end
+     *    doesn't hash the same (checked by the ROM adopting it), or
+     *  - the config file for its version has changed since it was written.
+     *
+     *  Failing to read or write the cache is never an error, the ROM just
+     *  gets opened the slow way.
+     *
+     *  The display lists found in a ROM's model files (see \c modelDLIndex())
+     *  get a second file next to that one, since they're only wanted when
+     *  browsing models, and take far longer to work out than the rest.
+     *
+     */
+    class IndexCache {
+      private:
+        std::string cachedir; ///< Directory holding the cache files
+
+        /** \brief Returns the path of a cache file for a ROM.
+         */
+        std::string pathFor(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC,
+                            const char * ext = "idx") const;
+
+      public:
+        /** \brief Version of the cache file layout
+         *
+         *  Bump this whenever the layout changes, or whenever the meaning of
+         *  anything in it does (such as how records get named), so older
+         *  entries stop being used.
+         *
+         */
+        static const uint32_t FORMAT_VERSION = 2;
+
+        /** \brief Version of the display list cache file layout
+         *
+         *  Like \c FORMAT_VERSION, but for the files from \c saveDLs(). This
+         *  also needs bumping when the search for display lists changes what
+         *  it finds.
+         *
+         */
+        static const uint32_t DL_FORMAT_VERSION = 1;
+
+        /** \brief Creates a cache using the given directory.
+         *
+         *  \param[in] dir The directory, which must already exist.
+         *
+         */
+        IndexCache(const std::string & dir);
+
+        /** \brief Looks for a valid entry for a ROM.
+         *
+         *  \param[in] romSize Size of the ROM data.
+         *
+         *  \param[in] headerCRC The CRC values in the ROM's header.
+         *
+         *  \param[out] out Where to put the entry, if found.
+         *
+         *  \returns \c true if a usable entry was found. Its \c headHash
+         *           still has to be checked against the ROM's data.
+         *
+         */
+        bool load(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC, CachedIndex & out) const;
+
+        /** \brief Saves the entry for a ROM, replacing any old one.
+         *
+         *  The file is written under a temporary name of its own and then
+         *  renamed into place, so other instances never see a half-written
+         *  entry, even when they're saving the same one.
+         *
+         *  \param[in] idx The entry to save.
+         *
+         */
+        void save(const CachedIndex & idx) const;
+
+        /** \brief Looks for a valid display list index for a ROM.
+         *
+         *  \param[in] romSize Size of the ROM data.
+         *
+         *  \param[in] headerCRC The CRC values in the ROM's header.
+         *
+         *  \param[in] sourceHash \c dlSourceHash() of the files the index
+         *                        should be of.
+         *
+         *  \param[out] out Where to put the index, if found.
+         *
+         *  \returns \c true if a usable index was found.
+         *
+         */
+        bool loadDLs(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC, uint64_t sourceHash,
+                     DLIndex & out) const;
+
+        /** \brief Saves the display list index for a ROM, replacing any old
+         *         one.
+         *
+         *  \param[in] romSize Size of the ROM data.
+         *
+         *  \param[in] headerCRC The CRC values in the ROM's header.
+         *
+         *  \param[in] idx The index to save.
+         *
+         */
+        void saveDLs(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC, const DLIndex & idx) const;
+    };
+}
\ No newline at end of file
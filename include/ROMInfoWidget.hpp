@@ -38,12 +38,14 @@ class ROMInfoWidget : public QWidget {
     QLabel * crc_chk;
 
     QPushButton * savebs;
+    QPushButton * savedec;
     QPushButton * viewtxt;
 
     QFutureWatcher<bool> crcverify;
 
   private slots:
     void saveROM();
+    void saveDecompressed();
     void checkedCRC();
     void browseText();
 
@@ -0,0 +1,106 @@
+/** \file ROMSource.hpp
+ *
+ *  \brief Declares the class providing the raw bytes of a ROM file.
+ *
+ */
+
+#pragma once
+
+#include <QFile>
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+
+namespace ROM {
+    /** \brief Class holding the raw bytes of a ROM file
+     *
+     *  A Source is what a ROM reads its data from. When constructed from a
+     *  filename, the file is memory-mapped read-only, so the bytes live in the
+     *  OS's page cache instead of being read (and copied) into our own
+     *  memory. Opening a ROM then only costs what we actually look at.
+     *
+     *  Sources can also be made from an existing vector of bytes, in which case
+     *  the Source simply owns that buffer.
+     *
+     *  Byteswapped ROMs need their data rearranged before we can use it, which
+     *  we obviously can't do to a read-only mapping. For that, \c
+     *  makePrivate() switches the Source over to a private, writable copy of
+     *  the data.
+     *
+     *  Sources can't be copied, since that would defeat the point; share them
+     *  by pointer instead.
+     *
+     */
+    class Source {
+      private:
+        QFile backing;                    ///< file being mapped, if any
+        const uint8_t * mapped = nullptr; ///< read-only mapping of \c backing
+        size_t mappedSize = 0;            ///< size of the mapping
+        std::vector<uint8_t> owned;       ///< private copy of data, when not mapped
+
+        /** \brief Releases the mapping, if there is one.
+         */
+        void unmap();
+
+      public:
+        /** \brief Creates a Source from the given file
+         *
+         *  This opens the file and maps it into memory. If mapping isn't
+         *  possible for whatever reason, we fall back to reading the file
+         *  into a private buffer, so the Source works either way.
+         *
+         *  \param[in] fname Path of the file to open.
+         *
+         *  \exception X::ROM::OpenError The file couldn't be opened or read.
+         *
+         */
+        Source(const std::string & fname);
+
+        /** \brief Creates a Source owning the given data
+         *
+         *  \param[in] rfile A vector of bytes for the Source to take over.
+         *
+         */
+        Source(std::vector<uint8_t> rfile);
+
+        Source(const Source &) = delete;
+        Source & operator=(const Source &) = delete;
+
+        ~Source();
+
+        /** \brief Returns a pointer to the start of the data.
+         *
+         *  \returns Pointer to the first byte of the ROM.
+         *
+         */
+        const uint8_t * data() const;
+
+        /** \brief Returns the size of the data in bytes.
+         *
+         *  \returns Size of the ROM in bytes.
+         *
+         */
+        size_t size() const;
+
+        /** \brief Indicates if the data is a memory mapping of a file.
+         *
+         *  \returns \c true if mapped, \c false if held in a private buffer.
+         *
+         */
+        bool isMapped() const;
+
+        /** \brief Switches to a private, writable copy of the data.
+         *
+         *  If the data is currently mapped, this copies it into a private
+         *  buffer and drops the mapping. Otherwise the existing buffer is used
+         *  as-is. This is meant for normalizing byteswapped dumps, and should
+         *  only be done before the data is handed out to anyone else.
+         *
+         *  \returns Writable pointer to the start of the data.
+         *
+         */
+        uint8_t * makePrivate();
+    };
+}
\ No newline at end of file
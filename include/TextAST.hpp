@@ -210,7 +210,22 @@ namespace TextAST {
     typedef std::map<Config::Language, std::map<uint16_t, MsgInfo>> MessageIndex;
 
     MessageIndex analyzeMsgTbl(const ROM::ROM & therom);
-        
+
+    /** \brief Writes a fragment of text in the markup the text viewer uses.
+     *
+     *  Control codes come out as commands like \c \\color{red}, and
+     *  literal text as-is.
+     *
+     */
+    std::string fragmentAsCode(Fragment frag);
+
+    /** \brief Writes a whole message in the markup the text viewer uses.
+     *
+     *  The message is wrapped in a \c message environment, with each box in
+     *  a \c box environment and each line of a box on its own line.
+     *
+     */
+    std::string messageAsCode(std::vector<Box> msg);
 }
 
 // put here to avoid the generic exceptions include depending on this one
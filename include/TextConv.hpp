@@ -11,8 +11,29 @@
 #include <vector>
 #include <cstdint>
 
-std::vector<TextAST::Box> readASCII_OoT(std::vector<uint8_t>::iterator & indata);
-std::vector<TextAST::Box> readShiftJIS_OoT(std::vector<uint8_t>::iterator & indata);
+std::vector<TextAST::Box> readASCII_OoT(const uint8_t * & indata);
+std::vector<TextAST::Box> readShiftJIS_OoT(const uint8_t * & indata);
 
-std::vector<TextAST::Box> readASCII_MM(std::vector<uint8_t>::iterator & indata);
-std::vector<TextAST::Box> readShiftJIS_MM(std::vector<uint8_t>::iterator & indata);
\ No newline at end of file
+std::vector<TextAST::Box> readASCII_MM(const uint8_t * & indata);
+std::vector<TextAST::Box> readShiftJIS_MM(const uint8_t * & indata);
+
+/** \brief Reads one message out of a ROM.
+ *
+ *  This picks the message file for the language, and the right reader for
+ *  the game and language. Majora's Mask keeps the box kind and position in
+ *  the message itself instead of the table, so for those \c minfo gets filled
+ *  in as the message is read.
+ *
+ *  \param[in] rom The ROM to read from.
+ *
+ *  \param[in] lang The language of the message.
+ *
+ *  \param[in,out] minfo The message's entry from \c TextAST::analyzeMsgTbl().
+ *
+ *  \returns The message.
+ *
+ *  \exception X::BadIndex The ROM has no message file for the language, or
+ *                         the message's address is past the end of it.
+ *
+ */
+std::vector<TextAST::Box> readMessage(const ROM::ROM & rom, Config::Language lang, TextAST::MsgInfo & minfo);
\ No newline at end of file
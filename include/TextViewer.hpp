@@ -44,7 +44,6 @@ class TextViewer : public QMainWindow {
 
     QWidget * dummy;
 
-    std::string fragAsCode(TextAST::Fragment frag);
     void writeCodeText();
 
   private slots:
@@ -0,0 +1,31 @@
+/** \file bytesearch.hpp
+ *
+ *  \brief Function for quickly finding byte strings in big buffers.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/** \brief Finds the first occurrence of a byte string in a buffer.
+ *
+ *  Works like \c std::search (or \c memmem), but with SSE2 where available it
+ *  checks 16 positions at a time, by first and last byte of the needle,
+ *  before comparing the rest. Meant for scanning whole ROMs.
+ *
+ *  \param[in] hay Buffer to search through.
+ *
+ *  \param[in] haysize Size of the buffer.
+ *
+ *  \param[in] needle Bytes to look for.
+ *
+ *  \param[in] needlesize Number of bytes to look for.
+ *
+ *  \returns Pointer to the first match, or <tt>hay + haysize</tt> if there
+ *           isn't one.
+ *
+ */
+const uint8_t * findBytes(const uint8_t * hay, size_t haysize,
+                          const uint8_t * needle, size_t needlesize);
\ No newline at end of file
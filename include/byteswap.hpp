@@ -0,0 +1,36 @@
+/** \file byteswap.hpp
+ *
+ *  \brief Functions for putting byteswapped data back in order, quickly.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/** \brief Swaps the bytes of every 16-bit unit in the buffer, in place.
+ *
+ *  This undoes (or does) the "byteswapped" layout of .v64 dumps, where \c
+ *  "zelda@" reads as \c "ezdl@a". Uses AVX2 or SSE2 where available. Any odd
+ *  byte at the end is left alone.
+ *
+ *  \param[in,out] data Start of the buffer.
+ *
+ *  \param[in] size Size of the buffer in bytes.
+ *
+ */
+void byteswap16(uint8_t * data, size_t size);
+
+/** \brief Reverses the bytes of every 32-bit unit in the buffer, in place.
+ *
+ *  This undoes (or does) the little-endian "word-swapped" layout of some .n64
+ *  dumps. Uses AVX2 or SSE2 where available. Any bytes past the last whole
+ *  word are left alone.
+ *
+ *  \param[in,out] data Start of the buffer.
+ *
+ *  \param[in] size Size of the buffer in bytes.
+ *
+ */
+void byteswap32(uint8_t * data, size_t size);
\ No newline at end of file
@@ -59,4 +59,22 @@ uint64_t be_u64(const ForwardIt & starting) {
     res |= static_cast<uint64_t>(*pnt++);
 
     return res;
+}
+
+template<typename ForwardIt>
+void be_write_u16(const ForwardIt & starting, uint16_t val) {
+    ForwardIt pnt = starting;
+
+    *pnt++ = val >>  8;
+    *pnt++ = val;
+}
+
+template<typename ForwardIt>
+void be_write_u32(const ForwardIt & starting, uint32_t val) {
+    ForwardIt pnt = starting;
+
+    *pnt++ = val >> 24;
+    *pnt++ = val >> 16;
+    *pnt++ = val >>  8;
+    *pnt++ = val;
 }
\ No newline at end of file
@@ -0,0 +1,28 @@
+/** \file hash.hpp
+ *
+ *  \brief Function for quickly hashing data.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/** \brief Hashes data with XXH64.
+ *
+ *  This is a fast, non-cryptographic 64-bit hash, good for telling whether
+ *  two files are the same without comparing them byte by byte (as long as
+ *  nobody's trying to fool us). It goes at several gigabytes per second, so
+ *  hashing a whole ROM is cheap.
+ *
+ *  \param[in] data Start of the data.
+ *
+ *  \param[in] size Size of the data in bytes.
+ *
+ *  \param[in] seed Starting value, to get a different family of hashes.
+ *
+ *  \returns The 64-bit hash.
+ *
+ */
+uint64_t hash64(const uint8_t * data, size_t size, uint64_t seed = 0);
\ No newline at end of file
@@ -6,7 +6,184 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <cstddef>
 #include <vector>
 
-std::vector<uint8_t> yaz0_decompress(std::vector<uint8_t> ciphertxt);
\ No newline at end of file
+/** \brief How hard \c yaz0_compress tries to find a small encoding
+ */
+enum class Yaz0Level {
+    FAST,   ///< greedy parse, short match search; for when speed matters most
+    NORMAL, ///< lazy parse, like Nintendo's own encoder
+    MAX,    ///< optimal parse over the longest match at every position
+};
+
+/** \brief Reads the decompressed size out of a Yaz0 header.
+ *
+ *  \param[in] ciphertxt Pointer to the compressed data.
+ *
+ *  \param[in] size Size of the compressed data.
+ *
+ *  \returns The size of the data once decompressed.
+ *
+ *  \exception X::Yaz0::Decompress The data doesn't start with a Yaz0 header.
+ *
+ */
+size_t yaz0_decompressed_size(const uint8_t * ciphertxt, size_t size);
+
+/** \brief Decompresses Yaz0 data into a buffer the caller provides.
+ *
+ *  Exactly \c yaz0_decompressed_size() bytes are written. The compressed data
+ *  is fully validated, so malformed input throws instead of reading or
+ *  writing out of bounds; the bulk of a file still gets decoded without
+ *  per-operation checks, only the start and the very end of it need them.
+ *
+ *  \param[in] ciphertxt Pointer to the compressed data.
+ *
+ *  \param[in] csize Size of the compressed data.
+ *
+ *  \param[out] plaintxt Where to write the decompressed data.
+ *
+ *  \param[in] psize Size of the output buffer, which must be at least the
+ *                   decompressed size.
+ *
+ *  \exception X::Yaz0::Decompress The data is malformed, or the output buffer
+ *                                 is too small.
+ *
+ */
+void yaz0_decompress_into(const uint8_t * ciphertxt, size_t csize, uint8_t * plaintxt, size_t psize);
+
+/** \brief Decompresses Yaz0 data into a new vector.
+ *
+ *  \param[in] ciphertxt Pointer to the compressed data.
+ *
+ *  \param[in] size Size of the compressed data.
+ *
+ *  \returns The decompressed data.
+ *
+ *  \exception X::Yaz0::Decompress The data is malformed.
+ *
+ */
+std::vector<uint8_t> yaz0_decompress(const uint8_t * ciphertxt, size_t size);
+
+/** \brief Decompresses Yaz0 data into a new vector.
+ *
+ *  Convenience overload for data already in a vector.
+ *
+ */
+std::vector<uint8_t> yaz0_decompress(const std::vector<uint8_t> & ciphertxt);
+
+/** \brief Decompresses Yaz0 data a piece at a time.
+ *
+ *  Unlike \c yaz0_decompress(), this only decodes as much as it's asked for,
+ *  and can pick up where it left off on the next \c read(). Back-references
+ *  are resolved against the stream's own copy of the last 4 KiB of output, so
+ *  callers can read into the same small buffer over and over, or just stop
+ *  once they've seen enough (say, the first few bytes to tell what kind of
+ *  file it is).
+ *
+ *  The stream doesn't copy the compressed data, so that must outlive it.
+ *
+ */
+class Yaz0Stream {
+  private:
+    const uint8_t * cipher_R_pnt; ///< next byte of compressed data to read
+    const uint8_t * cipher_end;   ///< end of compressed data
+
+    size_t total;        ///< decompressed size, from the header
+    size_t produced = 0; ///< bytes of output given out so far
+
+    uint8_t opset = 0;   ///< current opset byte, shifted so the next op is the top bit
+    uint8_t opsLeft = 0; ///< ops left in \c opset
+
+    size_t copyLeft = 0; ///< bytes left to copy from a back-reference in progress
+    size_t copyBack = 0; ///< distance of that back-reference
+
+    std::array<uint8_t, 0x1000> history; ///< last 4 KiB of output, indexed by position mod size
+
+  public:
+    /** \brief Starts decompressing the given data.
+     *
+     *  \param[in] ciphertxt Pointer to the compressed data.
+     *
+     *  \param[in] size Size of the compressed data.
+     *
+     *  \exception X::Yaz0::Decompress The data doesn't start with a Yaz0
+     *                                 header.
+     *
+     */
+    Yaz0Stream(const uint8_t * ciphertxt, size_t size);
+
+    /** \brief Decompresses up to \c count more bytes.
+     *
+     *  \param[out] out Where to put the bytes.
+     *
+     *  \param[in] count Most bytes to decompress.
+     *
+     *  \returns Number of bytes written, which is only less than \c count
+     *           once the end of the output is reached.
+     *
+     *  \exception X::Yaz0::Decompress The data is malformed.
+     *
+     */
+    size_t read(uint8_t * out, size_t count);
+
+    /** \brief Returns the total decompressed size.
+     */
+    size_t size() const;
+
+    /** \brief Returns how many bytes have been decompressed so far.
+     */
+    size_t position() const;
+
+    /** \brief Indicates if all the data has been decompressed.
+     */
+    bool done() const;
+};
+
+/** \brief Compresses data with Yaz0.
+ *
+ *  Matches are found with hash chains over the 4 KiB window, so even the \c
+ *  MAX level only looks at positions that actually share a three-byte prefix
+ *  with the current one, instead of scanning the whole window every time.
+ *
+ *  \param[in] plaintxt Pointer to the data to compress.
+ *
+ *  \param[in] size Number of bytes to compress.
+ *
+ *  \param[in] level How much effort to spend on the compression.
+ *
+ *  \returns The compressed data, including the Yaz0 header.
+ *
+ *  \exception X::Yaz0::Compress The data is too large for a Yaz0 header.
+ *
+ */
+std::vector<uint8_t> yaz0_compress(const uint8_t * plaintxt, size_t size,
+                                   Yaz0Level level = Yaz0Level::NORMAL);
+
+/** \brief Compresses data with Yaz0.
+ *
+ *  Convenience overload for data already in a vector.
+ *
+ */
+std::vector<uint8_t> yaz0_compress(const std::vector<uint8_t> & plaintxt,
+                                   Yaz0Level level = Yaz0Level::NORMAL);
+
+/** \brief Compresses many pieces of data with Yaz0, in parallel.
+ *
+ *  Each input is compressed on its own, spread across all cores, which is
+ *  what you want for rebuilding a whole ROM's worth of files.
+ *
+ *  \param[in] plaintxts Data to compress.
+ *
+ *  \param[in] level How much effort to spend on the compression.
+ *
+ *  \returns The compressed data, in the same order as the inputs.
+ *
+ *  \exception X::Yaz0::Compress One of the inputs is too large for a Yaz0
+ *                               header.
+ *
+ */
+std::vector<std::vector<uint8_t>> yaz0_compress_all(const std::vector<std::vector<uint8_t>> & plaintxts,
+                                                    Yaz0Level level = Yaz0Level::NORMAL);
\ No newline at end of file
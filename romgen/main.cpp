@@ -0,0 +1,181 @@
+/** \file main.cpp
+ *
+ *  \brief Entry point for the synthetic ROM generator.
+ *
+ *  This writes out what \c ROM::generate() makes, so test and benchmark ROMs
+ *  can be made without needing any real dumps.
+ *
+ */
+
+#include "ROMGen.hpp"
+#include "Exceptions.hpp"
+#include "utility.hpp"
+
+#include <QCoreApplication>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    void usage() {
+        std::cerr << "Usage: z64fe-romgen [options] <output file>\n\n"
+                  << "Options (numbers can be given in hex, with 0x):\n"
+                  << "  --shape many|huge      start from 10000 files, or a 256 MiB image, which the\n"
+                  << "                         other options then change\n"
+                  << "  --version <name>       version to imitate, like oot_ntsc_1.0 (the default)\n"
+                  << "  --files <n>            number of files\n"
+                  << "  --min-size <bytes>     smallest file size\n"
+                  << "  --max-size <bytes>     largest file size\n"
+                  << "  --compressed <frac>    fraction of files to compress, from 0 to 1\n"
+                  << "  --missing <frac>       fraction of files to list as missing, from 0 to 1\n"
+                  << "  --level fast|normal|max  how hard to compress\n"
+                  << "  --toc-at <offset>      where to put the TOC, instead of the version's usual place\n"
+                  << "  --size <bytes>         smallest size of the image\n"
+                  << "  --order z64|v64|n64    byte order of the image\n"
+                  << "  --seed <n>             seed for the contents\n";
+    }
+
+    Config::Version versionNamed(const std::string & name) {
+        for (int v = static_cast<int>(Config::Version::OOT_NTSC_1_0);
+             v <= static_cast<int>(Config::Version::MM_DEBUG); v++) {
+            if (Config::vFileStr(static_cast<Config::Version>(v)) == name) {
+                return static_cast<Config::Version>(v);
+            }
+        }
+
+        throw std::invalid_argument("unknown version \"" + name + "\"");
+    }
+
+    template<typename T>
+    T choice(const std::map<std::string, T> & choices, const std::string & opt, const std::string & val) {
+        auto found = choices.find(val);
+
+        if (found == choices.end()) {
+            throw std::invalid_argument("bad value \"" + val + "\" for " + opt);
+        }
+
+        return found->second;
+    }
+}
+
+int main(int argc, char ** argv) {
+    // only needed for the thread pool the files get made on
+    QCoreApplication qca(argc, argv);
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    ROM::GenOptions opts;
+    std::string outname;
+
+    try {
+        // the shape replaces every option, so it goes first wherever it's
+        // given, and the other options change it from there
+        for (size_t i = 0; i + 1 < args.size(); i++) {
+            if (args[i] == "--shape") {
+                opts = choice<ROM::GenOptions>({{"many", ROM::manyFilesShape()}, {"huge", ROM::hugeImageShape()}},
+                                               args[i], args[i + 1]);
+            }
+
+            if (args[i].substr(0, 2) == "--") {
+                i++;
+            }
+        }
+
+        for (size_t i = 0; i < args.size(); i++) {
+            const std::string & opt = args[i];
+
+            if (opt.substr(0, 2) != "--") {
+                if (!outname.empty()) {
+                    usage();
+                    return 1;
+                }
+
+                outname = opt;
+                continue;
+            }
+
+            if (i + 1 == args.size()) {
+                usage();
+                return 1;
+            }
+
+            const std::string & val = args[++i];
+
+            if (opt == "--shape") {
+                // applied before everything else, above
+            } else if (opt == "--version") {
+                opts.version = versionNamed(val);
+            } else if (opt == "--files") {
+                opts.files = std::stoull(val, nullptr, 0);
+            } else if (opt == "--min-size") {
+                opts.minFileSize = std::stoull(val, nullptr, 0);
+            } else if (opt == "--max-size") {
+                opts.maxFileSize = std::stoull(val, nullptr, 0);
+            } else if (opt == "--compressed") {
+                opts.compressed = std::stod(val);
+            } else if (opt == "--missing") {
+                opts.missing = std::stod(val);
+            } else if (opt == "--level") {
+                opts.level = choice<Yaz0Level>({{"fast", Yaz0Level::FAST},
+                                                {"normal", Yaz0Level::NORMAL},
+                                                {"max", Yaz0Level::MAX}}, opt, val);
+            } else if (opt == "--toc-at") {
+                opts.tocOffset = std::stoull(val, nullptr, 0);
+            } else if (opt == "--size") {
+                opts.minSize = std::stoull(val, nullptr, 0);
+            } else if (opt == "--order") {
+                opts.order = choice<ROM::ByteOrder>({{"z64", ROM::ByteOrder::BIG},
+                                                     {"v64", ROM::ByteOrder::SWAPPED_16},
+                                                     {"n64", ROM::ByteOrder::SWAPPED_32}}, opt, val);
+            } else if (opt == "--seed") {
+                opts.seed = std::stoul(val, nullptr, 0);
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (std::logic_error & e) {
+        // what stoull and friends throw for bad numbers
+        std::cerr << "Bad option: " << e.what() << "\n";
+        return 1;
+    }
+
+    if (outname.empty()) {
+        usage();
+        return 1;
+    }
+
+    try {
+        ROM::Generated gen = ROM::generate(opts);
+
+        std::ofstream out(outname, std::ios::binary);
+        out.write(reinterpret_cast<const char *>(gen.data.data()), gen.data.size());
+
+        if (!out) {
+            std::cerr << "Couldn't write " << outname << ".\n";
+            return 1;
+        }
+
+        size_t compressed = 0;
+        size_t missing = 0;
+
+        for (auto & r : gen.records) {
+            compressed += r.isCompressed();
+            missing += r.isMissing();
+        }
+
+        std::cout << "Wrote " << outname << ": " << sizeToIEC(gen.data.size()) << ", "
+                  << gen.records.size() << " TOC entries (" << compressed << " compressed, "
+                  << missing << " missing)\n";
+    } catch (Exception & e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -194,6 +194,113 @@ namespace Config {
         throw X::InternalError("missed version!");
     }
 
+    size_t tocOffset(Version v) {
+        switch (v) {
+          case Version::OOT_NTSC_1_0:
+          case Version::OOT_NTSC_1_1:
+          case Version::OOT_NTSC_1_2:
+            return 0x7430;
+            break;
+
+          case Version::OOT_PAL_1_0:
+          case Version::OOT_PAL_1_1:
+            return 0x7950;
+            break;
+
+          case Version::OOT_MQ_DEBUG:
+            return 0x12F70;
+            break;
+
+          case Version::MM_JP_1_0:
+            return 0x1C110;
+            break;
+
+          case Version::MM_JP_1_1:
+            return 0x1C050;
+            break;
+
+          case Version::MM_US:
+            return 0x1A500;
+            break;
+
+          case Version::MM_EU_1_0:
+            return 0x1A650;
+            break;
+
+          case Version::MM_EU_1_1:
+            return 0x1A8D0;
+            break;
+
+          case Version::MM_DEBUG:
+            return 0x24F60;
+            break;
+
+          case Version::UNKNOWN:
+            return 0;
+            break;
+        }
+
+        throw X::InternalError("missed version!");
+    }
+
+    std::string compileTime(Version v) {
+        switch (v) {
+          case Version::OOT_NTSC_1_0:
+            return "98-10-21 04:56:31";
+            break;
+
+          case Version::OOT_NTSC_1_1:
+            return "98-10-26 10:58:45";
+            break;
+
+          case Version::OOT_NTSC_1_2:
+            return "98-11-12 18:17:03";
+            break;
+
+          case Version::OOT_PAL_1_0:
+            return "98-11-10 14:32:22";
+            break;
+
+          case Version::OOT_PAL_1_1:
+            return "98-11-18 17:36:49";
+            break;
+
+          case Version::OOT_MQ_DEBUG:
+            return "03-02-21 00:16:31";
+            break;
+
+          case Version::MM_JP_1_0:
+            return "00-03-31 02:22:11";
+            break;
+
+          case Version::MM_JP_1_1:
+            return "00-04-04 09:34:16";
+            break;
+
+          case Version::MM_US:
+            return "00-07-31 17:04:16";
+            break;
+
+          case Version::MM_EU_1_0:
+            return "00-09-25 11:16:53";
+            break;
+
+          case Version::MM_EU_1_1:
+            return "00-09-29 09:29:41";
+            break;
+
+          case Version::MM_DEBUG:
+            return "00-09-29 09:29:05";
+            break;
+
+          case Version::UNKNOWN:
+            return "";
+            break;
+        }
+
+        throw X::InternalError("missed version!");
+    }
+
     std::string langString(Language L) {
         switch (L) {
           case Language::JP:
@@ -12,6 +12,7 @@
 #include <QStandardPaths>
 #include <QFileInfo>
 
+#include <cstdlib>
 #include <sstream>
 #include <algorithm>
 #include <iostream>
@@ -287,7 +288,50 @@ std::string ConfigTree::findKey(std::initializer_list<std::string> ingroup, std:
     return cur_res->key();
 }
 
-ConfigTree getConfigTree(Config::Version forVer) {
+std::unordered_map<uint32_t, std::string> ConfigTree::numericValueKeys(std::initializer_list<std::string> ingroup) const {
+    std::unordered_map<uint32_t, std::string> res;
+
+    ConfigTreeNode * cur_res = rootNode;
+
+    for (auto & i : ingroup) {
+        if (cur_res == nullptr) {
+            return res;
+        }
+
+        cur_res = cur_res->childMatchKey(i);
+    }
+
+    if (cur_res == nullptr) {
+        return res;
+    }
+
+    res.reserve(cur_res->numChildren());
+
+    for (auto & i : *cur_res) {
+        if (i->isGroup()) {
+            continue;
+        }
+
+        std::string val = i->value();
+
+        if (val.size() < 3 || val[0] != '0' || (val[1] != 'x' && val[1] != 'X')) {
+            continue;
+        }
+
+        char * numend;
+        unsigned long num = std::strtoul(val.c_str() + 2, &numend, 16);
+
+        if (*numend != '\0' || num > 0xFFFFFFFF) {
+            continue;
+        }
+
+        res.emplace(static_cast<uint32_t>(num), i->key());
+    }
+
+    return res;
+}
+
+std::string configFilePath(Config::Version forVer) {
     QString getfrom = QStandardPaths::locate(QStandardPaths::AppDataLocation,
                                              (vFileStr(forVer) + ".cfg").c_str());
 
@@ -295,11 +339,21 @@ ConfigTree getConfigTree(Config::Version forVer) {
         getfrom = QString("%1/%2").arg(PInfo::DEVSHAREPATH.c_str()).arg((vFileStr(forVer) + ".cfg").c_str());
 
         if (!QFileInfo(getfrom).exists()) {
-            return ConfigTree();
+            return "";
         }
     }
 
-    std::ifstream cfile(getfrom.toStdString());
+    return getfrom.toStdString();
+}
+
+ConfigTree getConfigTree(Config::Version forVer) {
+    std::string getfrom = configFilePath(forVer);
+
+    if (getfrom == "") {
+        return ConfigTree();
+    }
+
+    std::ifstream cfile(getfrom);
 
     if (!cfile) {
         return ConfigTree();
@@ -69,6 +69,22 @@ namespace X {
         std::string NoMagic::what() {
             return "Magic string not found; are you sure this is a Zelda ROM?";
         }
+
+        OpenError::OpenError(std::string r) : reason(r) { }
+
+        std::string OpenError::what() {
+            return "Couldn't open ROM file: " + reason;
+        }
+
+        std::string Cancelled::what() {
+            return "Opening the ROM was cancelled.";
+        }
+
+        GenError::GenError(std::string r) : reason(r) { }
+
+        std::string GenError::what() {
+            return "Couldn't generate ROM: " + reason;
+        }
     }
 
     namespace Config {
@@ -98,6 +114,12 @@ namespace X {
         std::string Decompress::what() {
             return "Error in decompressing file: " + reason;
         }
+
+        Compress::Compress(std::string r) : reason(r) { }
+
+        std::string Compress::what() {
+            return "Error in compressing file: " + reason;
+        }
     }
 
     namespace Text {
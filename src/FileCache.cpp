@@ -0,0 +1,139 @@
+/** \file FileCache.cpp
+ *
+ *  \brief Implements the thread-safe file cache.
+ *
+ */
+
+#include "FileCache.hpp"
+#include "ROM.hpp"
+
+namespace ROM {
+    const size_t FileCache::DEFAULT_BUDGET;
+    const size_t FileCache::NUM_SHARDS;
+
+    FileCache::Shard & FileCache::shardFor(size_t key) {
+        // virtual addresses tend to be aligned, so skip the lowest bits and
+        // fold the higher ones down before taking the low ones.
+        size_t h = (key >> 4) ^ (key >> 12) ^ (key >> 20);
+
+        return shards[h & (NUM_SHARDS - 1)];
+    }
+
+    void FileCache::evictLocked(Shard & sh) {
+        size_t allowed = budget / NUM_SHARDS;
+
+        while (sh.resident > allowed && sh.lru.size() > 1) {
+            auto victim = sh.entries.find(sh.lru.back());
+
+            sh.resident -= victim->second.bytes;
+            resident -= victim->second.bytes;
+            evictions++;
+
+            sh.entries.erase(victim);
+            sh.lru.pop_back();
+        }
+    }
+
+    FileCache::Entry FileCache::get(size_t key, const Loader & load) {
+        Shard & sh = shardFor(key);
+
+        std::promise<Entry> loading;
+        std::shared_future<Entry> waitfor;
+
+        {
+            std::lock_guard<std::mutex> guard(sh.lock);
+
+            auto found = sh.entries.find(key);
+
+            if (found != sh.entries.end()) {
+                hits++;
+
+                if (found->second.ready) {
+                    sh.lru.splice(sh.lru.begin(), sh.lru, found->second.age);
+                }
+
+                waitfor = found->second.result;
+            } else {
+                misses++;
+
+                // claim this key before letting go of the lock, so anyone else
+                // asking for it waits on us instead of loading it themselves.
+                sh.entries[key].result = loading.get_future().share();
+            }
+        }
+
+        if (waitfor.valid()) {
+            return waitfor.get();
+        }
+
+        Entry res;
+
+        try {
+            res = std::make_shared<const File>(load());
+        } catch (...) {
+            loading.set_exception(std::current_exception());
+
+            std::lock_guard<std::mutex> guard(sh.lock);
+            sh.entries.erase(key);
+
+            throw;
+        }
+
+        loading.set_value(res);
+
+        std::lock_guard<std::mutex> guard(sh.lock);
+
+        auto slot = sh.entries.find(key);
+
+        // the cache may have been cleared while we were loading, in which case
+        // there's nothing to keep track of anymore.
+        if (slot != sh.entries.end() && !slot->second.ready) {
+            sh.lru.push_front(key);
+
+            slot->second.ready = true;
+            slot->second.bytes = res->size();
+            slot->second.age = sh.lru.begin();
+
+            sh.resident += res->size();
+            resident += res->size();
+
+            evictLocked(sh);
+        }
+
+        return res;
+    }
+
+    void FileCache::clear() {
+        for (auto & sh : shards) {
+            std::lock_guard<std::mutex> guard(sh.lock);
+
+            resident -= sh.resident;
+
+            sh.entries.clear();
+            sh.lru.clear();
+            sh.resident = 0;
+        }
+    }
+
+    void FileCache::setBudget(size_t bytes) {
+        budget = bytes;
+
+        for (auto & sh : shards) {
+            std::lock_guard<std::mutex> guard(sh.lock);
+            evictLocked(sh);
+        }
+    }
+
+    size_t FileCache::getBudget() const { return budget; }
+
+    FileCache::Stats FileCache::stats() const {
+        Stats res;
+
+        res.hits = hits;
+        res.misses = misses;
+        res.evictions = evictions;
+        res.residentBytes = resident;
+
+        return res;
+    }
+}
\ No newline at end of file
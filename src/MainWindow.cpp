@@ -9,6 +9,8 @@
 #include "Hex/Widget.hpp"
 #include "TextViewer.hpp"
 #include "ObjViewer.hpp"
+#include "ROMDiff.hpp"
+#include "ROMIndexCache.hpp"
 #include "projectinfo.hpp"
 
 #include <QToolBar>
@@ -16,13 +18,22 @@
 #include <QCloseEvent>
 #include <QSettings>
 #include <QFileDialog>
-#include <QFile>
 #include <QMessageBox>
 #include <QMdiSubWindow>
 #include <QApplication>
+#include <QPlainTextEdit>
+#include <QFontDatabase>
+#include <QFileInfo>
+#include <QtConcurrent>
+
+#include <exception>
+#include <memory>
+#include <sstream>
 
 MainWindow::MainWindow() {
     the_rom = nullptr;
+    open_monitor = nullptr;
+    open_progress = nullptr;
 
     main_portal = new QMdiArea(this);
 
@@ -43,6 +54,9 @@ MainWindow::MainWindow() {
                            this);
     load_rom->setShortcut(QKeySequence::Open);
 
+    diff_rom = new QAction(tr("&Compare With ROM..."), this);
+    diff_rom->setEnabled(false);
+
     exit_prog = new QAction(QIcon::fromTheme("application-exit", QIcon(":/icons/application-exit.svg")),
                             tr("&Exit"),
                             this);
@@ -56,6 +70,7 @@ MainWindow::MainWindow() {
 
     file_menu = menuBar()->addMenu(tr("&File"));
     file_menu->addAction(load_rom);
+    file_menu->addAction(diff_rom);
     file_menu->addSeparator();
     file_menu->addAction(exit_prog);
 
@@ -79,7 +94,12 @@ MainWindow::MainWindow() {
     connect(this, &MainWindow::romChanged, file_list_widget, &ROMFileWidget::changeROM);
     connect(this, &MainWindow::romChanged, rom_info_widget, &ROMInfoWidget::changeROM);
 
+    // the stages are reached on the opening thread, so this gets queued
+    connect(this, &MainWindow::openStageReached, this, &MainWindow::showOpenStage);
+    connect(&open_watcher, &QFutureWatcher<OpenResult>::finished, this, &MainWindow::finishOpen);
+
     connect(load_rom, &QAction::triggered, this, &MainWindow::openROM);
+    connect(diff_rom, &QAction::triggered, this, &MainWindow::compareROM);
     connect(exit_prog, &QAction::triggered, this, &MainWindow::close);
     connect(about_this, &QAction::triggered, this, &MainWindow::aboutMe);
     connect(about_qt, &QAction::triggered, &QApplication::aboutQt);
@@ -90,10 +110,20 @@ MainWindow::MainWindow() {
 }
 
 void MainWindow::closeEvent(QCloseEvent * ev) {
+    // don't leave a ROM opening with nobody to take it
+    if (open_watcher.isRunning()) {
+        open_monitor->cancel();
+        open_watcher.waitForFinished();
+    }
+
     ev->accept();
 }
 
 void MainWindow::openROM() {
+    if (open_watcher.isRunning()) {
+        return;
+    }
+
     QSettings qs;
     QString fileName = QFileDialog::getOpenFileName(
         this, tr("Open ROM"),
@@ -106,28 +136,191 @@ void MainWindow::openROM() {
 
     qs.setValue("main/lastfile", fileName);
 
-    QFile rfile(fileName);
+    startOpen(fileName, false);
+}
+
+std::string MainWindow::indexCacheDir() {
+    QSettings qs;
+
+    // ROMs we've opened before have what we found out about them cached, so
+    // they don't need to be examined all over again.
+    if (!qs.value("cache/index_enabled", true).toBool()) {
+        return "";
+    }
+
+    return ROM::defaultIndexDir();
+}
+
+void MainWindow::startOpen(const QString & fileName, bool compare) {
+    std::string indexDir = indexCacheDir();
+    QString shortName = QFileInfo(fileName).fileName();
+
+    open_compare = compare ? shortName : QString();
+
+    open_monitor = new ROM::OpenMonitor([this](ROM::OpenStage s) {
+        openStageReached(static_cast<int>(s));
+    });
+
+    // comparing goes on past the ROM being ready, so leave room for it; a
+    // dialog at its maximum closes itself
+    int steps = static_cast<int>(ROM::OpenStage::DONE) + (compare ? 1 : 0);
 
-    if (!rfile.open(QIODevice::ReadOnly)) {
-        QMessageBox::critical(this, tr("File Error"), rfile.errorString() + "\n(Don't worry, you can still work with the last ROM)");
+    open_progress = new QProgressDialog(tr("Opening %1...").arg(shortName), tr("Cancel"), 0, steps, this);
+    open_progress->setWindowTitle(compare ? tr("Comparing ROMs") : tr("Opening ROM"));
+
+    open_progress->setMinimumDuration(500);
+    open_progress->setValue(0);
+
+    ROM::OpenMonitor * mon = open_monitor;
+
+    connect(open_progress, &QProgressDialog::canceled, [mon]() { mon->cancel(); });
+
+    // no opening (or comparing against) anything else until this is done
+    load_rom->setEnabled(false);
+    diff_rom->setEnabled(false);
+
+    std::string fname = fileName.toStdString();
+
+    // nothing can replace the current ROM until this is done, so it's safe
+    // to compare against from the other thread
+    const ROM::ROM * base = compare ? the_rom : nullptr;
+
+    open_watcher.setFuture(QtConcurrent::run([fname, indexDir, mon, base]() {
+        OpenResult res;
+
+        try {
+            // map the file, rather than reading all of it in; the ROM only
+            // looks at what it needs.
+            mon->reached(ROM::OpenStage::MAPPING);
+
+            std::unique_ptr<ROM::ROM> rom(new ROM::ROM(std::make_shared<ROM::Source>(fname), indexDir, mon));
+
+            if (base == nullptr) {
+                res.rom = rom.release();
+                return res;
+            }
+
+            // this hashes every file of both ROMs, which is the slow part
+            try {
+                std::stringstream report;
+
+                ROM::writeDiffReport(report, ROM::diffROMs(*base, *rom));
+
+                res.report = QString::fromStdString(report.str());
+                res.compared = true;
+            } catch (Exception & e) {
+                res.errTitle = tr("Comparison Error");
+                res.errText = QString(e.what().c_str());
+            }
+        } catch (X::ROM::Cancelled &) {
+            // they know already, nothing to say
+        } catch (X::ROM::OpenError & e) {
+            res.errTitle = tr("File Error");
+            res.errText = QString(e.what().c_str()) + "\n(Don't worry, you can still work with the last ROM)";
+        } catch (Exception & e) {
+            res.errTitle = tr("ROM Handling Error");
+            res.errText = QString(e.what().c_str()) + "\n(You can still work on the previous ROM)";
+        } catch (std::exception & e) {
+            res.errTitle = tr("ROM Handling Error");
+            res.errText = QString(e.what()) + "\n(You can still work on the previous ROM)";
+        }
+
+        return res;
+    }));
+}
+
+void MainWindow::showOpenStage(int stage) {
+    if (open_progress == nullptr) {
         return;
     }
 
-    std::vector<uint8_t> rdat;
-    QByteArray junk = rfile.readAll();
+    switch (static_cast<ROM::OpenStage>(stage)) {
+      case ROM::OpenStage::MAPPING:
+        open_progress->setLabelText(tr("Reading the file..."));
+        break;
+
+      case ROM::OpenStage::UNSWAPPING:
+        open_progress->setLabelText(tr("Checking the byte order..."));
+        break;
+
+      case ROM::OpenStage::CACHE:
+        open_progress->setLabelText(tr("Looking for the ROM in the index cache..."));
+        break;
+
+      case ROM::OpenStage::IDENTIFYING:
+        open_progress->setLabelText(tr("Identifying the version..."));
+        break;
 
-    std::copy(junk.begin(), junk.end(), std::back_inserter(rdat));
+      case ROM::OpenStage::READING_TOC:
+        open_progress->setLabelText(tr("Reading the table of contents..."));
+        break;
 
-    // now to create the ROM itself, and hopefully it's OK.
-    ROM::ROM * nrom;
+      case ROM::OpenStage::NAMING:
+        open_progress->setLabelText(tr("Naming the files..."));
+        break;
 
-    try {
-        nrom = new ROM::ROM(rdat);
-    } catch (Exception & e) {
-        QMessageBox::critical(this, tr("ROM Handling Error"), QString(e.what().c_str()) + "\n(You can still work on the previous ROM)");
+      case ROM::OpenStage::SAVING:
+        open_progress->setLabelText(tr("Saving to the index cache..."));
+        break;
+
+      case ROM::OpenStage::DONE:
+        if (!open_compare.isEmpty()) {
+            open_progress->setLabelText(tr("Comparing with %1...").arg(open_compare));
+        }
+        break;
+    }
+
+    open_progress->setValue(stage);
+}
+
+void MainWindow::finishOpen() {
+    OpenResult res = open_watcher.result();
+
+    // a cancel that came too late to stop the opening still counts
+    bool cancelled = open_monitor->isCancelled();
+
+    delete open_monitor;
+    open_monitor = nullptr;
+
+    delete open_progress;
+    open_progress = nullptr;
+
+    QString compared = open_compare;
+    open_compare.clear();
+
+    load_rom->setEnabled(true);
+    diff_rom->setEnabled(the_rom != nullptr);
+
+    if (cancelled) {
+        delete res.rom;
+        return;
+    }
+
+    if (res.compared) {
+        QPlainTextEdit * view = new QPlainTextEdit(res.report);
+        view->setReadOnly(true);
+        view->setLineWrapMode(QPlainTextEdit::NoWrap);
+        view->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+        view->setWindowTitle(tr("Compared With %1").arg(compared));
+
+        main_portal->addSubWindow(view)->show();
         return;
     }
 
+    if (res.rom == nullptr) {
+        QMessageBox::critical(this, res.errTitle, res.errText);
+        return;
+    }
+
+    ROM::ROM * nrom = res.rom;
+
+    // how much memory (in MiB) decompressed files may take up
+    QSettings qs;
+
+    nrom->setCacheBudget(qs.value("cache/decompressed_mib",
+                                  static_cast<qulonglong>(ROM::FileCache::DEFAULT_BUDGET / (1024 * 1024))).toULongLong()
+                         * 1024 * 1024);
+
     std::swap(the_rom, nrom);
 
     // signal the change in ROM to everyone who needs it
@@ -136,10 +329,32 @@ void MainWindow::openROM() {
 
     // we can now safely delete the old rom
     delete nrom;
+
+    diff_rom->setEnabled(true);
+}
+
+void MainWindow::compareROM() {
+    if (the_rom == nullptr || open_watcher.isRunning()) {
+        return;
+    }
+
+    QSettings qs;
+    QString fileName = QFileDialog::getOpenFileName(
+        this, tr("Compare With ROM"),
+        qs.value("main/last_diff_rom", qs.value("main/lastfile", QString())).toString(),
+        tr("N64 ROM Files (*.z64 *.n64);;All files (*)"));
+
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    qs.setValue("main/last_diff_rom", fileName);
+
+    startOpen(fileName, true);
 }
 
 void MainWindow::makeHexWindow(ROM::File rf) {
-    QByteArray qba(reinterpret_cast<char *>(rf.getData().data()), rf.size());
+    QByteArray qba(reinterpret_cast<const char *>(rf.data()), rf.size());
     main_portal->addSubWindow(new Hex::Widget(qba))->show();
 }
 
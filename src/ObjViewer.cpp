@@ -53,6 +53,6 @@ void ObjViewer::selectItem(const QModelIndex & cur, const QModelIndex & /*prev*/
     qte->clear();
 
     for (auto & i : dl_map.at(addr)) {
-        qte->append(i->id().c_str());
+        qte->append(i.name());
     }
 }
\ No newline at end of file
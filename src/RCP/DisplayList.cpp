@@ -15,10 +15,281 @@
 
 namespace RCP {
     namespace Command {
-        NOOP::NOOP(uint64_t instr) {
+        namespace {
+            /* Where each command keeps its values, as the F3DEX2 microcode
+             * lays them out. Both the constructors and the problem() checks
+             * read from these, so every field is only written down once. */
+            namespace Layout {
+                typedef Field< 0, 32>          Word;    ///< The whole low word, usually an address
+                typedef Field<24,  8, uint8_t> Segment; ///< The segment of an address in the low word
+
+                /** \brief The color in the low word of the color commands
+                 */
+                struct Color {
+                    typedef Field<24, 8, uint8_t> R;
+                    typedef Field<16, 8, uint8_t> G;
+                    typedef Field< 8, 8, uint8_t> B;
+                    typedef Field< 0, 8, uint8_t> A;
+                };
+
+                /** \brief Two corners and a tile, as the rectangle and tile
+                 *         loading commands have them
+                 */
+                struct Rect {
+                    typedef Field<32 + 12, 12, uint16_t> x1;
+                    typedef Field<32,      12, uint16_t> y1;
+                    typedef Field<24,       3, uint8_t>  tile_no;
+                    typedef Field<12,      12, uint16_t> x2;
+                    typedef Field< 0,      12, uint16_t> y2;
+                };
+
+                /** \brief The image format of SETTILE, SETTIMG and SETCIMG
+                 */
+                struct Format {
+                    typedef Field<32 + 21, 3, uint8_t> colors;
+                    typedef Field<32 + 19, 2, uint8_t> size;
+                };
+
+                struct VTX {
+                    typedef Field<32 + 12, 8, uint8_t> size;
+                    typedef Field<32 +  1, 7, uint8_t> end_idx;
+                };
+
+                struct MODIFYVTX {
+                    typedef Field<32 + 16,  8, uint8_t>  where;
+                    typedef Field<32 +  1, 15, uint16_t> dst_idx;
+                };
+
+                struct CULLDL {
+                    typedef Field<32 + 1, 15, uint16_t> begin_idx;
+                    typedef Field<     1, 15, uint16_t> end_idx;
+                };
+
+                struct BRANCH_Z {
+                    typedef Field<32 + 12, 12, uint16_t> test_idx_5; ///< five times the index
+                    typedef Field<32 +  1, 11, uint16_t> test_idx;
+                };
+
+                struct TRI {
+                    typedef Field<32 + 17, 7, uint8_t> v0;
+                    typedef Field<32 +  9, 7, uint8_t> v1;
+                    typedef Field<32 +  1, 7, uint8_t> v2;
+                    typedef Field<     17, 7, uint8_t> v3;
+                    typedef Field<      9, 7, uint8_t> v4;
+                    typedef Field<      1, 7, uint8_t> v5;
+                };
+
+                struct DMA_IO {
+                    typedef Field<32 + 23,  1, bool>     to_rcp;
+                    typedef Field<32 + 13, 10, uint16_t> dmem_qwords;
+                    typedef Field<32,      12, uint16_t> size_less_one;
+                };
+
+                struct TEXTURE {
+                    typedef Field<32 + 11,  3, uint8_t>  extra_mipmaps;
+                    typedef Field<32 +  8,  3, uint8_t>  tile_no;
+                    typedef Field<32,       8, uint8_t>  on;
+                    typedef Field<16,      16, uint16_t> scale_S;
+                    typedef Field< 0,      16, uint16_t> scale_T;
+                };
+
+                struct GEOMETRYMODE {
+                    typedef Field<32, 24> clear_bits;
+                };
+
+                struct MTX {
+                    typedef Field<32 + 0, 1, bool> no_push;
+                    typedef Field<32 + 1, 1, bool> load;
+                    typedef Field<32 + 2, 1, bool> projection;
+                };
+
+                struct MOVEWORD {
+                    typedef Field<32 + 16,  8, uint8_t>  idx;
+                    typedef Field<32,      16, uint16_t> offset;
+                };
+
+                struct MOVEMEM {
+                    typedef Field<32 + 19, 5, uint8_t> size_qwords;
+                    typedef Field<32 +  8, 8, uint8_t> offset;
+                    typedef Field<32,      8, uint8_t> idx;
+                };
+
+                struct LOAD_UCODE {
+                    typedef Field<32, 16, uint16_t> data_size;
+                };
+
+                struct DL {
+                    typedef Field<32 + 16, 8, uint8_t> style;
+                };
+
+                struct SETOTHERMODE {
+                    typedef Field<32 + 8, 8, uint8_t> shift_from_top;
+                    typedef Field<32,     8, uint8_t> size_less_one;
+                };
+
+                struct SETKEYGB {
+                    typedef Field<32 + 12, 12, uint16_t> width_G;
+                    typedef Field<32,      12, uint16_t> width_B;
+                    typedef Field<24,       8, uint8_t>  center_G;
+                    typedef Field<16,       8, uint8_t>  scale_G;
+                    typedef Field< 8,       8, uint8_t>  center_B;
+                    typedef Field< 0,       8, uint8_t>  scale_B;
+                };
+
+                struct SETKEYR {
+                    typedef Field<16, 12, uint16_t> width_R;
+                    typedef Field< 8,  8, uint8_t>  center_R;
+                    typedef Field< 0,  8, uint8_t>  scale_R;
+                };
+
+                struct SETCONVERT {
+                    typedef Field<9 * 5, 9, int16_t> k0;
+                    typedef Field<9 * 4, 9, int16_t> k1;
+                    typedef Field<9 * 3, 9, int16_t> k2;
+                    typedef Field<9 * 2, 9, int16_t> k3;
+                    typedef Field<9 * 1, 9, int16_t> k4;
+                    typedef Field<9 * 0, 9, int16_t> k5;
+                };
+
+                struct SETSCISSOR {
+                    typedef Rect::x1              x1;
+                    typedef Rect::y1              y1;
+                    typedef Field<28, 4, uint8_t> mode;
+                    typedef Rect::x2              x2;
+                    typedef Rect::y2              y2;
+                };
+
+                struct SETPRIMDEPTH {
+                    typedef Field<16, 16, int16_t> Z;
+                    typedef Field< 0, 16, int16_t> delta_Z;
+                };
+
+                struct RDPSETOTHERMODE {
+                    typedef Field<32, 24> high_bits;
+                };
+
+                struct LOADTLUT {
+                    typedef Field<24,  3, uint8_t>  tile_no;
+                    typedef Field<14, 10, uint16_t> last_color_idx;
+                };
+
+                struct SETTILE : Format {
+                    typedef Field<32 + 9, 9, uint16_t> u64_per_row;
+                    typedef Field<32,     9, uint16_t> tmem_address;
+                    typedef Field<24,     3, uint8_t>  tile_no;
+                    typedef Field<20,     4, uint8_t>  pal_no;
+                    typedef Field<19,     1, bool>     clamp_T;
+                    typedef Field<18,     1, bool>     mirror_T;
+                    typedef Field<14,     4, uint8_t>  mask_T;
+                    typedef Field<10,     4, uint8_t>  shift_T;
+                    typedef Field< 9,     1, bool>     clamp_S;
+                    typedef Field< 8,     1, bool>     mirror_S;
+                    typedef Field< 4,     4, uint8_t>  mask_S;
+                    typedef Field< 0,     4, uint8_t>  shift_S;
+                };
+
+                struct SETPRIMCOLOR : Color {
+                    typedef Field<32 + 8, 8, uint8_t> min_lod;
+                    typedef Field<32,     8, uint8_t> lod_frac;
+                };
+
+                struct SETCOMBINE {
+                    typedef Field<32 + 20, 4> color_1a;
+                    typedef Field<32 + 15, 5> color_1c;
+                    typedef Field<32 + 12, 3> alpha_1a;
+                    typedef Field<32 +  9, 3> alpha_1c;
+                    typedef Field<32 +  5, 4> color_2a;
+                    typedef Field<32,      5> color_2c;
+                    typedef Field<28,      4> color_1b;
+                    typedef Field<24,      4> color_2b;
+                    typedef Field<21,      3> alpha_2a;
+                    typedef Field<18,      3> alpha_2c;
+                    typedef Field<15,      3> color_1d;
+                    typedef Field<12,      3> alpha_1b;
+                    typedef Field< 9,      3> alpha_1d;
+                    typedef Field< 6,      3> color_2d;
+                    typedef Field< 3,      3> alpha_2b;
+                    typedef Field< 0,      3> alpha_2d;
+                };
+
+                /** \brief SETTIMG and SETCIMG
+                 */
+                struct SETIMG : Format {
+                    typedef Field<32, 12, uint16_t> width_less_one;
+                };
+            }
+
+            /** \brief Throws the problem with a command's values, if any.
+             */
+            template<typename T>
+            void validate(uint64_t instr) {
+                const char * why = T::problem(instr);
+
+                if (why != nullptr) {
+                    throw X::RCP::BadCommand(T::sid(), instr, why);
+                }
+            }
+
+            /** \brief Checks the image format of a SETTILE, SETTIMG or SETCIMG.
+             */
+            const char * formatProblem(uint64_t instr) {
+                uint8_t colors = Layout::Format::colors::get(instr);
+
+                if (colors > 0x04) {
+                    return "Impossible color format given";
+                }
+
+                if (!Image::hasFormat(static_cast<Image::Colors>(colors),
+                                      static_cast<Image::Size>(Layout::Format::size::get(instr)))) {
+                    return "Image format not allowed in the RCP";
+                }
+
+                return nullptr;
+            }
+
+            /** \brief Reads the image format of a SETTILE, SETTIMG or SETCIMG,
+             *         which \c formatProblem() has to have passed.
+             */
+            Image::Format readFormat(uint64_t instr) {
+                return Image::getFormat(static_cast<Image::Colors>(Layout::Format::colors::get(instr)),
+                                        static_cast<Image::Size>(Layout::Format::size::get(instr)));
+            }
+
+            /** \brief Checks the bits a SETOTHERMODE_L or SETOTHERMODE_H
+             *         sets.
+             */
+            const char * otherModeProblem(uint64_t instr) {
+                unsigned size = Layout::SETOTHERMODE::size_less_one::get(instr) + 1;
+                unsigned fromTop = Layout::SETOTHERMODE::shift_from_top::get(instr);
+
+                // the fields can ask for bits past either end of the word,
+                // which has to be ruled out before the shifts below are safe
+                if (size + fromTop > 32) {
+                    return "Bits to set don't fit in the mode word";
+                }
+
+                uint64_t mask = ((uint64_t(1) << size) - 1) << (32 - fromTop - size);
+                uint32_t value = Layout::Word::get(instr);
+
+                // weird validity check to do here, just see if the given value
+                // is shifted as expected.
+                if ((value & mask) != value) {
+                    return "Odd value given to set";
+                }
+
+                return nullptr;
+            }
+        }
+
+        const char * Any::problem(uint64_t /*instr*/) { return nullptr; }
+
+
+
+
+        NOOP::NOOP(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0x00);
 
-            tag = instr & 0xFFFFFFFF;
+            tag = Layout::Word::get(instr);
         }
 
         std::string NOOP::sid() { return "G_NOOP"; }
@@ -27,32 +298,40 @@ namespace RCP {
 
 
 
-        VTX::VTX(uint64_t instr) {
+        VTX::VTX(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0x01);
 
-            size = instr >> (32 + 12) & 0xFF;
-            dst_idx = ((instr >> 32 & 0xFF) >> 1) - size;
-            ram_address = instr & 0xFFFFFFFF;
+            validate<VTX>(instr);
+
+            size = Layout::VTX::size::get(instr);
+            dst_idx = Layout::VTX::end_idx::get(instr) - size;
+            ram_address = Layout::Word::get(instr);
+        }
+
+        const char * VTX::problem(uint64_t instr) {
+            uint8_t size = Layout::VTX::size::get(instr);
+            uint8_t dst_idx = Layout::VTX::end_idx::get(instr) - size;
 
-            //// VALIDITY CHECK
             // 1. Make sure size and dst_idx are in range
             if (!(1 <= size && size <= 32)) {
-                throw X::RCP::BadCommand(sid(), instr, "Size out of range");
+                return "Size out of range";
             }
 
             if (!(dst_idx <= 31)) {
-                throw X::RCP::BadCommand(sid(), instr, "Destination index out of range");
+                return "Destination index out of range";
             }
 
             // 2. Check that destination index + size don't exceed 32 vertices.
             if (size + dst_idx > 32) {
-                throw X::RCP::BadCommand(sid(), instr, "Attempting to load vertices past endpoint");
+                return "Attempting to load vertices past endpoint";
             }
 
             // 3. Check segment address for valid segment
-            if ((ram_address >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Invalid segment for segment address");
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Invalid segment for segment address";
             }
+
+            return nullptr;
         }
 
         std::string VTX::sid() { return "G_VTX"; }
@@ -61,10 +340,12 @@ namespace RCP {
 
 
 
-        MODIFYVTX::MODIFYVTX(uint64_t instr) {
+        MODIFYVTX::MODIFYVTX(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0x02);
 
-            switch (instr >> (32 + 16) & 0xFF) {
+            validate<MODIFYVTX>(instr);
+
+            switch (Layout::MODIFYVTX::where::get(instr)) {
               case 0x10:
                 where = Change::RGBA;
                 break;
@@ -86,13 +367,28 @@ namespace RCP {
                 break;
             }
 
-            dst_idx = (instr >> 32 & 0xFFFF) / 2;
-            value = instr & 0xFFFFFFFF;
+            dst_idx = Layout::MODIFYVTX::dst_idx::get(instr);
+            value = Layout::Word::get(instr);
+        }
 
-            //// VALIDITY CHECK
-            if (!(dst_idx <= 31)) {
-                throw X::RCP::BadCommand(sid(), instr, "Bad vertex index");
+        const char * MODIFYVTX::problem(uint64_t instr) {
+            switch (Layout::MODIFYVTX::where::get(instr)) {
+              case 0x10:
+              case 0x14:
+              case 0x18:
+              case 0x1C:
+                break;
+
+              default:
+                return "Invalid modification index";
+                break;
+            }
+
+            if (!(Layout::MODIFYVTX::dst_idx::get(instr) <= 31)) {
+                return "Bad vertex index";
             }
+
+            return nullptr;
         }
 
         std::string MODIFYVTX::sid() { return "G_MODIFYVTX"; }
@@ -101,26 +397,34 @@ namespace RCP {
 
 
 
-        CULLDL::CULLDL(uint64_t instr) {
+        CULLDL::CULLDL(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0x03);
 
-            begin_idx = (instr >> 32 & 0xFFFF) / 2;
-            end_idx = (instr & 0xFFFF) / 2;
+            validate<CULLDL>(instr);
+
+            begin_idx = Layout::CULLDL::begin_idx::get(instr);
+            end_idx = Layout::CULLDL::end_idx::get(instr);
+        }
+
+        const char * CULLDL::problem(uint64_t instr) {
+            uint16_t begin_idx = Layout::CULLDL::begin_idx::get(instr);
+            uint16_t end_idx = Layout::CULLDL::end_idx::get(instr);
 
-            //// VALIDITY CHECK
             // 1. Check indexes
             if (!(begin_idx <= 31)) {
-                throw X::RCP::BadCommand(sid(), instr, "Bad start index");
+                return "Bad start index";
             }
 
             if (!(end_idx <= 31)) {
-                throw X::RCP::BadCommand(sid(), instr, "Bad end index");
+                return "Bad end index";
             }
 
             // 2. check that the indices specify a real list
             if (!(begin_idx < end_idx)) {
-                throw X::RCP::BadCommand(sid(), instr, "Invalid vertex list given");
+                return "Invalid vertex list given";
             }
+
+            return nullptr;
         }
 
         std::string CULLDL::sid() { return "G_CULLDL"; }
@@ -129,17 +433,23 @@ namespace RCP {
 
 
 
-        BRANCH_Z::BRANCH_Z(uint64_t instr) {
+        BRANCH_Z::BRANCH_Z(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0x04);
 
-            test_idx = (instr >> (32 + 12) & 0xFFF) / 5;
-            test_idx_2 = (instr >> 32 & 0xFFF) / 2;
+            validate<BRANCH_Z>(instr);
+
+            test_idx = Layout::BRANCH_Z::test_idx_5::get(instr) / 5;
+            test_idx_2 = Layout::BRANCH_Z::test_idx::get(instr);
+
+            z_value = Layout::Word::get(instr);
+        }
 
-            if (test_idx != test_idx_2) {
-                throw X::RCP::BadCommand(sid(), instr, "Given indices aren't the same");
+        const char * BRANCH_Z::problem(uint64_t instr) {
+            if (Layout::BRANCH_Z::test_idx_5::get(instr) / 5 != Layout::BRANCH_Z::test_idx::get(instr)) {
+                return "Given indices aren't the same";
             }
 
-            z_value = instr & 0xFFFFFFFF;
+            return nullptr;
         }
 
         std::string BRANCH_Z::sid() { return "G_BRANCH_Z"; }
@@ -148,19 +458,24 @@ namespace RCP {
 
 
 
-        TRI1::TRI1(uint64_t instr) {
+        TRI1::TRI1(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0x05);
 
-            vtx_idxs[0] = (instr >> (32 + 16) & 0xFF) / 2;
-            vtx_idxs[1] = (instr >> (32 +  8) & 0xFF) / 2;
-            vtx_idxs[2] = (instr >>  32       & 0xFF) / 2;
+            validate<TRI1>(instr);
 
-            //// VALIDITY CHECK
-            for (auto & i : vtx_idxs) {
-                if (!(i <= 31)) {
-                    throw X::RCP::BadCommand(sid(), instr, "A vertex index was out of range");
+            vtx_idxs[0] = Layout::TRI::v0::get(instr);
+            vtx_idxs[1] = Layout::TRI::v1::get(instr);
+            vtx_idxs[2] = Layout::TRI::v2::get(instr);
+        }
+
+        const char * TRI1::problem(uint64_t instr) {
+            for (uint8_t idx : {Layout::TRI::v0::get(instr), Layout::TRI::v1::get(instr), Layout::TRI::v2::get(instr)}) {
+                if (!(idx <= 31)) {
+                    return "A vertex index was out of range";
                 }
             }
+
+            return nullptr;
         }
 
         std::string TRI1::sid() { return "G_TRI1"; }
@@ -169,22 +484,29 @@ namespace RCP {
 
 
 
-        TRI2::TRI2(uint64_t instr) {
+        TRI2::TRI2(uint64_t instr) : Any(KIND) {
             // check two of them since we subsume QUAD into this
             assert(instr >> 56 == 0x06 || instr >> 56 == 0x07);
 
-            vtx_idxs[0] = (instr >> (32 + 16) & 0xFF) / 2;
-            vtx_idxs[1] = (instr >> (32 +  8) & 0xFF) / 2;
-            vtx_idxs[2] = (instr >>  32       & 0xFF) / 2;
-            vtx_idxs[3] = (instr >>  16       & 0xFF) / 2;
-            vtx_idxs[4] = (instr >>   8       & 0xFF) / 2;
-            vtx_idxs[5] = (instr              & 0xFF) / 2;
+            validate<TRI2>(instr);
+
+            vtx_idxs[0] = Layout::TRI::v0::get(instr);
+            vtx_idxs[1] = Layout::TRI::v1::get(instr);
+            vtx_idxs[2] = Layout::TRI::v2::get(instr);
+            vtx_idxs[3] = Layout::TRI::v3::get(instr);
+            vtx_idxs[4] = Layout::TRI::v4::get(instr);
+            vtx_idxs[5] = Layout::TRI::v5::get(instr);
+        }
 
-            for (auto & i : vtx_idxs) {
-                if (!(i <= 31)) {
-                    throw X::RCP::BadCommand(sid(), instr, "A vertex index was out of range");
+        const char * TRI2::problem(uint64_t instr) {
+            for (uint8_t idx : {Layout::TRI::v0::get(instr), Layout::TRI::v1::get(instr), Layout::TRI::v2::get(instr),
+                                Layout::TRI::v3::get(instr), Layout::TRI::v4::get(instr), Layout::TRI::v5::get(instr)}) {
+                if (!(idx <= 31)) {
+                    return "A vertex index was out of range";
                 }
             }
+
+            return nullptr;
         }
 
         std::string TRI2::sid() { return "G_TRI2"; }
@@ -193,23 +515,28 @@ namespace RCP {
 
 
 
-        DMA_IO::DMA_IO(uint64_t instr) {
+        DMA_IO::DMA_IO(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xD6);
 
-            if (instr >> (32 + 23) & 1) {
+            validate<DMA_IO>(instr);
+
+            if (Layout::DMA_IO::to_rcp::get(instr)) {
                 direction = Mode::ToRCP;
             } else {
                 direction = Mode::FromRCP;
             }
 
-            dmem_address = (instr >> (32 + 13) & 0x3FF) * 8;
-            size = (instr >> 32 & 0xFFF) + 1;
-            ram_address = instr & 0xFFFFFFFF;
+            dmem_address = Layout::DMA_IO::dmem_qwords::get(instr) * 8;
+            size = Layout::DMA_IO::size_less_one::get(instr) + 1;
+            ram_address = Layout::Word::get(instr);
+        }
 
-            //// VALIDITY CHECK
-            if ((ram_address >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Invalid segment for segment address");
+        const char * DMA_IO::problem(uint64_t instr) {
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Invalid segment for segment address";
             }
+
+            return nullptr;
         }
 
         std::string DMA_IO::sid() { return "G_DMA_IO"; }
@@ -218,22 +545,27 @@ namespace RCP {
 
 
 
-        TEXTURE::TEXTURE(uint64_t instr) {
+        TEXTURE::TEXTURE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xD7);
 
-            extra_mipmaps = instr >> (32 + 11) & 0x07;
-            tile_no = instr >> (32 + 8) & 0x07;
-            on = instr >> 32 & 0xFF;
+            validate<TEXTURE>(instr);
 
-            scale_S = instr >> 16 & 0xFFFF;
-            scale_T = instr & 0xFFFF;
+            extra_mipmaps = Layout::TEXTURE::extra_mipmaps::get(instr);
+            tile_no = Layout::TEXTURE::tile_no::get(instr);
+            on = Layout::TEXTURE::on::get(instr);
 
-            //// VALIDITY CHECK
+            scale_S = Layout::TEXTURE::scale_S::get(instr);
+            scale_T = Layout::TEXTURE::scale_T::get(instr);
+        }
+
+        const char * TEXTURE::problem(uint64_t instr) {
             // make sure it's not asking for more mipmaps than possible for this
             // tile descriptor.
-            if (tile_no + extra_mipmaps > 0x07) {
-                throw X::RCP::BadCommand(sid(), instr, "Too many levels for tile descriptor");
+            if (Layout::TEXTURE::tile_no::get(instr) + Layout::TEXTURE::extra_mipmaps::get(instr) > 0x07) {
+                return "Too many levels for tile descriptor";
             }
+
+            return nullptr;
         }
 
         std::string TEXTURE::sid() { return "G_TEXTURE"; }
@@ -242,16 +574,21 @@ namespace RCP {
 
 
 
-        POPMTX::POPMTX(uint64_t instr) {
+        POPMTX::POPMTX(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xD8);
 
-            pop_num = (instr & 0xFFFFFFFF) / 64;
+            validate<POPMTX>(instr);
 
-            //// VALIDITY CHECK
+            pop_num = Layout::Word::get(instr) / 64;
+        }
+
+        const char * POPMTX::problem(uint64_t instr) {
             // not asking for too many matrices?
-            if (pop_num > 18) {
-                throw X::RCP::BadCommand(sid(), instr, "Asked to pop too many matrices");
+            if (Layout::Word::get(instr) / 64 > 18) {
+                return "Asked to pop too many matrices";
             }
+
+            return nullptr;
         }
 
         std::string POPMTX::sid() { return "G_POPMTX"; }
@@ -260,13 +597,11 @@ namespace RCP {
 
 
 
-        GEOMETRYMODE::GEOMETRYMODE(uint64_t instr) {
+        GEOMETRYMODE::GEOMETRYMODE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xD9);
 
-            clear_this = instr >> 32 & 0xFFFFFF;
-            clear_this = ~clear_this; // do this after so we know we only invert 32 bits
-
-            set_this = instr & 0xFFFFFFFF;
+            clear_this = ~Layout::GEOMETRYMODE::clear_bits::get(instr);
+            set_this = Layout::Word::get(instr);
         }
 
         std::string GEOMETRYMODE::sid() { return "G_GEOMETRYMODE"; }
@@ -275,31 +610,36 @@ namespace RCP {
 
 
 
-        MTX::MTX(uint64_t instr) {
+        MTX::MTX(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xDA);
 
+            validate<MTX>(instr);
+
             // the push bit is inverted for some reason, so true is false and
             // vice versa.
-            try_push = !(instr >> 32 & 1);
+            try_push = !Layout::MTX::no_push::get(instr);
 
-            if (instr >> 33 & 1) {
+            if (Layout::MTX::load::get(instr)) {
                 load_style = Loading::Load;
             } else {
                 load_style = Loading::Multiply;
             }
 
-            if (instr >> 34 & 1) {
+            if (Layout::MTX::projection::get(instr)) {
                 mtx_stack = Stack::Projection;
             } else {
                 mtx_stack = Stack::ModelView;
             }
 
-            ram_address = instr & 0xFFFFFFFF;
+            ram_address = Layout::Word::get(instr);
+        }
 
-            //// VALIDITY CHECK
-            if ((ram_address >> 24) > 0xF) {
-                throw X::RCP::BadCommand(sid(), instr, "Invalid segment for segment address");
+        const char * MTX::problem(uint64_t instr) {
+            if (Layout::Segment::get(instr) > 0xF) {
+                return "Invalid segment for segment address";
             }
+
+            return nullptr;
         }
 
         std::string MTX::sid() { return "G_MTX"; }
@@ -308,10 +648,12 @@ namespace RCP {
 
 
 
-        MOVEWORD::MOVEWORD(uint64_t instr) {
+        MOVEWORD::MOVEWORD(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xDB);
 
-            switch (instr >> (32 + 16) & 0xFF) {
+            validate<MOVEWORD>(instr);
+
+            switch (Layout::MOVEWORD::idx::get(instr)) {
               case 0x00:
                 idx = Index::Matrix;
                 break;
@@ -348,8 +690,18 @@ namespace RCP {
                 throw X::RCP::BadCommand(sid(), instr, "Invalid DMA index");
             }
 
-            offset = instr >> 32 & 0xFFFF;
-            value = instr & 0xFFFFFFFF;
+            offset = Layout::MOVEWORD::offset::get(instr);
+            value = Layout::Word::get(instr);
+        }
+
+        const char * MOVEWORD::problem(uint64_t instr) {
+            uint8_t idx = Layout::MOVEWORD::idx::get(instr);
+
+            if (idx > 0x0E || idx % 2 != 0) {
+                return "Invalid DMA index";
+            }
+
+            return nullptr;
         }
 
         std::string MOVEWORD::sid() { return "G_MOVEWORD"; }
@@ -358,12 +710,14 @@ namespace RCP {
 
 
 
-        MOVEMEM::MOVEMEM(uint64_t instr) {
+        MOVEMEM::MOVEMEM(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xDC);
 
-            size = ((instr >> (32 + 16) & 0xFF) >> 3) * 8 + 1;
-            offset = instr >> (32 + 8) & 0xFF;
-            switch (instr >> 32 & 0xFF) {
+            validate<MOVEMEM>(instr);
+
+            size = Layout::MOVEMEM::size_qwords::get(instr) * 8 + 1;
+            offset = Layout::MOVEMEM::offset::get(instr);
+            switch (Layout::MOVEMEM::idx::get(instr)) {
               case 0x08:
                 idx = Index::Viewport;
                 break;
@@ -380,11 +734,26 @@ namespace RCP {
                 throw X::RCP::BadCommand(sid(), instr, "Invalid or unsupported DMA index");
                 break;
             }
-            src_address = instr & 0xFFFFFFFF;
+            src_address = Layout::Word::get(instr);
+        }
+
+        const char * MOVEMEM::problem(uint64_t instr) {
+            switch (Layout::MOVEMEM::idx::get(instr)) {
+              case 0x08:
+              case 0x0A:
+              case 0x0E:
+                break;
+
+              default:
+                return "Invalid or unsupported DMA index";
+                break;
+            }
 
-            if ((src_address >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Invalid segment for segment address");
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Invalid segment for segment address";
             }
+
+            return nullptr;
         }
 
         std::string MOVEMEM::sid() { return "G_MOVEMEM"; }
@@ -393,15 +762,21 @@ namespace RCP {
 
 
 
-        LOAD_UCODE::LOAD_UCODE(uint64_t instr) {
+        LOAD_UCODE::LOAD_UCODE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xDD);
 
-            data_size = instr >> 32 & 0xFFFF;
-            text_start = instr & 0xFFFFFFFF;
+            validate<LOAD_UCODE>(instr);
 
-            if ((text_start >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Invalid segment for segment address");
+            data_size = Layout::LOAD_UCODE::data_size::get(instr);
+            text_start = Layout::Word::get(instr);
+        }
+
+        const char * LOAD_UCODE::problem(uint64_t instr) {
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Invalid segment for segment address";
             }
+
+            return nullptr;
         }
 
         std::string LOAD_UCODE::sid() { return "G_LOAD_UCODE"; }
@@ -410,10 +785,12 @@ namespace RCP {
 
 
 
-        DL::DL(uint64_t instr) {
+        DL::DL(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xDE);
 
-            switch (instr >> (32 + 16) & 0xFF) {
+            validate<DL>(instr);
+
+            switch (Layout::DL::style::get(instr)) {
               case 0x00:
                 ret_type = Style::Call;
                 break;
@@ -427,11 +804,19 @@ namespace RCP {
                 break;
             }
 
-            goto_address = instr & 0xFFFFFFFF;
+            goto_address = Layout::Word::get(instr);
+        }
+
+        const char * DL::problem(uint64_t instr) {
+            if (Layout::DL::style::get(instr) > 0x01) {
+                return "Invalid call style for DL command";
+            }
 
-            if ((goto_address >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Invalid segment for segment address");
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Invalid segment for segment address";
             }
+
+            return nullptr;
         }
 
         std::string DL::sid() { return "G_DL"; }
@@ -439,24 +824,24 @@ namespace RCP {
 
 
 
-        ENDDL::ENDDL(uint64_t instr) { assert(instr >> 56 == 0xDF); }
+        ENDDL::ENDDL(uint64_t instr) : Any(KIND) { assert(instr >> 56 == 0xDF); }
         std::string ENDDL::sid() { return "G_ENDDL"; }
         std::string ENDDL::id() { return sid(); }
 
 
 
 
-        SPNOOP::SPNOOP(uint64_t instr) { assert(instr >> 56 == 0xE0); }
+        SPNOOP::SPNOOP(uint64_t instr) : Any(KIND) { assert(instr >> 56 == 0xE0); }
         std::string SPNOOP::sid() { return "G_SPNOOP"; }
         std::string SPNOOP::id() { return sid(); }
 
 
 
 
-        RDPHALF_1::RDPHALF_1(uint64_t instr) {
+        RDPHALF_1::RDPHALF_1(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xE1);
 
-            high_word = instr & 0xFFFFFFFF;
+            high_word = Layout::Word::get(instr);
         }
 
         std::string RDPHALF_1::sid() { return "G_RDPHALF_1"; }
@@ -465,19 +850,18 @@ namespace RCP {
 
 
 
-        SETOTHERMODE_L::SETOTHERMODE_L(uint64_t instr) {
+        SETOTHERMODE_L::SETOTHERMODE_L(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xE2);
 
-            size = (instr >> 32 & 0xFF) + 1;
-            shift = 32 - (instr >> (32 + 8) & 0xFF) - size;
-            value = instr & 0xFFFFFFFF;
+            validate<SETOTHERMODE_L>(instr);
 
-            // weird validity check to do here, just see if the given value is
-            // shifted as expected.
+            size = Layout::SETOTHERMODE::size_less_one::get(instr) + 1;
+            shift = 32 - Layout::SETOTHERMODE::shift_from_top::get(instr) - size;
+            value = Layout::Word::get(instr);
+        }
 
-            if ((value & (((1 << size) - 1) << shift)) != value) {
-                throw X::RCP::BadCommand(sid(), instr, "Odd value given to set");
-            }
+        const char * SETOTHERMODE_L::problem(uint64_t instr) {
+            return otherModeProblem(instr);
         }
 
         std::string SETOTHERMODE_L::sid() { return "G_SETOTHERMODE_L"; }
@@ -486,19 +870,18 @@ namespace RCP {
 
 
 
-        SETOTHERMODE_H::SETOTHERMODE_H(uint64_t instr) {
+        SETOTHERMODE_H::SETOTHERMODE_H(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xE3);
 
-            size = (instr >> 32 & 0xFF) + 1;
-            shift = 32 - (instr >> (32 + 8) & 0xFF) - size;
-            value = instr & 0xFFFFFFFF;
+            validate<SETOTHERMODE_H>(instr);
 
-            // weird validity check to do here, just see if the given value is
-            // shifted as expected.
+            size = Layout::SETOTHERMODE::size_less_one::get(instr) + 1;
+            shift = 32 - Layout::SETOTHERMODE::shift_from_top::get(instr) - size;
+            value = Layout::Word::get(instr);
+        }
 
-            if ((value & (((1 << size) - 1) << shift)) != value) {
-                throw X::RCP::BadCommand(sid(), instr, "Odd value given to set");
-            }
+        const char * SETOTHERMODE_H::problem(uint64_t instr) {
+            return otherModeProblem(instr);
         }
 
         std::string SETOTHERMODE_H::sid() { return "G_SETOTHERMODE_H"; }
@@ -507,16 +890,16 @@ namespace RCP {
 
 
 
-        TEXRECT::TEXRECT(uint64_t instr) {
+        TEXRECT::TEXRECT(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xE4);
 
-            lrx = instr >> (32 + 12) & 0xFFF;
-            lry = instr >> 32 & 0xFFF;
+            lrx = Layout::Rect::x1::get(instr);
+            lry = Layout::Rect::y1::get(instr);
 
-            tile_no = instr >> 24 & 0x7;
+            tile_no = Layout::Rect::tile_no::get(instr);
 
-            ulx = instr >> 12 & 0xFFF;
-            uly = instr & 0xFFF;
+            ulx = Layout::Rect::x2::get(instr);
+            uly = Layout::Rect::y2::get(instr);
         }
 
         std::string TEXRECT::sid() { return "G_TEXRECT"; }
@@ -525,16 +908,16 @@ namespace RCP {
 
 
 
-        TEXRECTFLIP::TEXRECTFLIP(uint64_t instr) {
+        TEXRECTFLIP::TEXRECTFLIP(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xE5);
 
-            lrx = instr >> (32 + 12) & 0xFFF;
-            lry = instr >> 32 & 0xFFF;
+            lrx = Layout::Rect::x1::get(instr);
+            lry = Layout::Rect::y1::get(instr);
 
-            tile_no = instr >> 24 & 0x7;
+            tile_no = Layout::Rect::tile_no::get(instr);
 
-            ulx = instr >> 12 & 0xFFF;
-            uly = instr & 0xFFF;
+            ulx = Layout::Rect::x2::get(instr);
+            uly = Layout::Rect::y2::get(instr);
         }
 
         std::string TEXRECTFLIP::sid() { return "G_TEXRECTFLIP"; }
@@ -543,45 +926,45 @@ namespace RCP {
 
 
 
-        RDPLOADSYNC::RDPLOADSYNC(uint64_t instr) { assert(instr >> 56 == 0xE6); }
+        RDPLOADSYNC::RDPLOADSYNC(uint64_t instr) : Any(KIND) { assert(instr >> 56 == 0xE6); }
         std::string RDPLOADSYNC::sid() { return "G_RDPLOADSYNC"; }
         std::string RDPLOADSYNC::id() { return sid(); }
 
 
 
 
-        RDPPIPESYNC::RDPPIPESYNC(uint64_t instr) { assert(instr >> 56 == 0xE7); }
+        RDPPIPESYNC::RDPPIPESYNC(uint64_t instr) : Any(KIND) { assert(instr >> 56 == 0xE7); }
         std::string RDPPIPESYNC::sid() { return "G_RDPPIPESYNC"; }
         std::string RDPPIPESYNC::id() { return sid(); }
 
 
 
 
-        RDPTILESYNC::RDPTILESYNC(uint64_t instr) { assert(instr >> 56 == 0xE8); }
+        RDPTILESYNC::RDPTILESYNC(uint64_t instr) : Any(KIND) { assert(instr >> 56 == 0xE8); }
         std::string RDPTILESYNC::sid() { return "G_RDPTILESYNC"; }
         std::string RDPTILESYNC::id() { return sid(); }
 
 
 
 
-        RDPFULLSYNC::RDPFULLSYNC(uint64_t instr) { assert(instr >> 56 == 0xE9); }
+        RDPFULLSYNC::RDPFULLSYNC(uint64_t instr) : Any(KIND) { assert(instr >> 56 == 0xE9); }
         std::string RDPFULLSYNC::sid() { return "G_RDPFULLSYNC"; }
         std::string RDPFULLSYNC::id() { return sid(); }
 
 
 
 
-        SETKEYGB::SETKEYGB(uint64_t instr) {
+        SETKEYGB::SETKEYGB(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xEA);
 
-            width_G = instr >> (32 + 12) & 0xFFF;
-            width_B = instr >> 32 & 0xFFF;
+            width_G = Layout::SETKEYGB::width_G::get(instr);
+            width_B = Layout::SETKEYGB::width_B::get(instr);
 
-            center_G = instr >> 24 & 0xFF;
-            scale_G  = instr >> 16 & 0xFF;
+            center_G = Layout::SETKEYGB::center_G::get(instr);
+            scale_G  = Layout::SETKEYGB::scale_G::get(instr);
 
-            center_B = instr >> 8 & 0xFF;
-            scale_B  = instr & 0xFF;
+            center_B = Layout::SETKEYGB::center_B::get(instr);
+            scale_B  = Layout::SETKEYGB::scale_B::get(instr);
         }
 
         std::string SETKEYGB::sid() { return "G_SETKEYGB"; }
@@ -590,12 +973,12 @@ namespace RCP {
 
 
 
-        SETKEYR::SETKEYR(uint64_t instr) {
+        SETKEYR::SETKEYR(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xEB);
 
-            width_R  = instr >> 16 & 0xFFF;
-            center_R = instr >> 8 & 0xFF;
-            scale_R  = instr & 0xFF;
+            width_R  = Layout::SETKEYR::width_R::get(instr);
+            center_R = Layout::SETKEYR::center_R::get(instr);
+            scale_R  = Layout::SETKEYR::scale_R::get(instr);
         }
 
         std::string SETKEYR::sid() { return "G_SETKEYR"; }
@@ -604,37 +987,16 @@ namespace RCP {
 
 
 
-        SETCONVERT::SETCONVERT(uint64_t instr) {
+        SETCONVERT::SETCONVERT(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xEC);
 
-            std::array<uint16_t, 6> prek;
-            prek[0] = instr >> (9 * 5) & 0x1FF;
-            prek[1] = instr >> (9 * 4) & 0x1FF;
-            prek[2] = instr >> (9 * 3) & 0x1FF;
-            prek[3] = instr >> (9 * 2) & 0x1FF;
-            prek[4] = instr >> (9 * 1) & 0x1FF;
-            prek[5] = instr            & 0x1FF;
-
-            // now to handle doing the sign extension, in a standards-compliant
-            // way (not accidentally relying on UB or implementation-defined
-            // behavior).
-            std::transform(prek.begin(), prek.end(), k.begin(),
-                           [](const uint16_t & a) {
-                               int16_t res;
-
-                               if (a >> 8) {
-                                   // decomplement, then re-negate, in a way
-                                   // that won't stumble across UB or i-d
-                                   // behavior.
-                                   res = 512 - a;
-                                   res = -res;
-                               } else {
-                                   // this one's easy
-                                   res = a;
-                               }
-
-                               return res;
-                           });
+            // Field takes care of the sign extension
+            k[0] = Layout::SETCONVERT::k0::get(instr);
+            k[1] = Layout::SETCONVERT::k1::get(instr);
+            k[2] = Layout::SETCONVERT::k2::get(instr);
+            k[3] = Layout::SETCONVERT::k3::get(instr);
+            k[4] = Layout::SETCONVERT::k4::get(instr);
+            k[5] = Layout::SETCONVERT::k5::get(instr);
         }
 
         std::string SETCONVERT::sid() { return "G_SETCONVERT"; }
@@ -643,13 +1005,15 @@ namespace RCP {
 
 
 
-        SETSCISSOR::SETSCISSOR(uint64_t instr) {
+        SETSCISSOR::SETSCISSOR(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xED);
 
-            ulx = instr >> (32 + 12) & 0xFFF;
-            uly = instr >> 32 & 0xFFF;
+            validate<SETSCISSOR>(instr);
 
-            switch (instr >> 28 & 0x0F) {
+            ulx = Layout::SETSCISSOR::x1::get(instr);
+            uly = Layout::SETSCISSOR::y1::get(instr);
+
+            switch (Layout::SETSCISSOR::mode::get(instr)) {
               case 0x00:
                 scanlines = Mode::All;
                 break;
@@ -667,8 +1031,20 @@ namespace RCP {
                 break;
             }
 
-            lrx = instr >> 12 & 0xFFF;
-            lry = instr & 0xFFF;
+            lrx = Layout::SETSCISSOR::x2::get(instr);
+            lry = Layout::SETSCISSOR::y2::get(instr);
+        }
+
+        const char * SETSCISSOR::problem(uint64_t instr) {
+            switch (Layout::SETSCISSOR::mode::get(instr)) {
+              case 0x00:
+              case 0x02:
+              case 0x03:
+                return nullptr;
+                break;
+            }
+
+            return "Invalid scanline mode value";
         }
 
         std::string SETSCISSOR::sid() { return "G_SETSCISSOR"; }
@@ -677,32 +1053,11 @@ namespace RCP {
 
 
 
-        SETPRIMDEPTH::SETPRIMDEPTH(uint64_t instr) {
+        SETPRIMDEPTH::SETPRIMDEPTH(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xEE);
 
-            // we handle the signed numbers like this to make sure we store
-            // things in a standards-compliant way (since we can't guarantee
-            // that your system uses two's-complement, even though that means
-            // your system has issues, so reinterpret_cast is out. static_cast
-            // is out because the standard won't specify how to handle a uint
-            // with bigger value than the destination int, so hoping it'll do
-            // the correct 2's-comp magic like with signed->unsigned is folly).
-            uint16_t uZ = instr >> 16 & 0xFFFF;
-            uint16_t udZ = instr & 0xFFFF;
-
-            if (uZ >> 15) {
-                Z = 0x10000 - uZ;
-                Z = -Z;
-            } else {
-                Z = uZ;
-            }
-
-            if (udZ >> 15) {
-                delta_Z = 0x10000 - udZ;
-                delta_Z = -delta_Z;
-            } else {
-                delta_Z = udZ;
-            }
+            Z = Layout::SETPRIMDEPTH::Z::get(instr);
+            delta_Z = Layout::SETPRIMDEPTH::delta_Z::get(instr);
         }
 
         std::string SETPRIMDEPTH::sid() { return "G_SETPRIMDEPTH"; }
@@ -711,11 +1066,11 @@ namespace RCP {
 
 
 
-        RDPSETOTHERMODE::RDPSETOTHERMODE(uint64_t instr) {
+        RDPSETOTHERMODE::RDPSETOTHERMODE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xEF);
 
-            high_bits = instr >> 32 && 0xFFFFFF;
-            low_bits  = instr & 0xFFFFFFFF;
+            high_bits = Layout::RDPSETOTHERMODE::high_bits::get(instr);
+            low_bits  = Layout::Word::get(instr);
         }
 
         std::string RDPSETOTHERMODE::sid() { return "G_RDPSETOTHERMODE"; }
@@ -724,15 +1079,21 @@ namespace RCP {
 
 
 
-        LOADTLUT::LOADTLUT(uint64_t instr) {
+        LOADTLUT::LOADTLUT(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF0);
 
-            tile_no = instr >> 24 & 0x7;
-            last_color_idx = (instr >> 12 & 0xFFF) >> 2;
+            validate<LOADTLUT>(instr);
+
+            tile_no = Layout::LOADTLUT::tile_no::get(instr);
+            last_color_idx = Layout::LOADTLUT::last_color_idx::get(instr);
+        }
 
-            if (last_color_idx > 0xFF) {
-                throw X::RCP::BadCommand(sid(), instr, "Too many colors requested");
+        const char * LOADTLUT::problem(uint64_t instr) {
+            if (Layout::LOADTLUT::last_color_idx::get(instr) > 0xFF) {
+                return "Too many colors requested";
             }
+
+            return nullptr;
         }
 
         std::string LOADTLUT::sid() { return "G_LOADTLUT"; }
@@ -741,10 +1102,10 @@ namespace RCP {
 
 
 
-        RDPHALF_2::RDPHALF_2(uint64_t instr) {
+        RDPHALF_2::RDPHALF_2(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF1);
 
-            low_word = instr & 0xFFFFFFFF;
+            low_word = Layout::Word::get(instr);
         }
 
         std::string RDPHALF_2::sid() { return "G_RDPHALF2"; }
@@ -753,14 +1114,14 @@ namespace RCP {
 
 
 
-        SETTILESIZE::SETTILESIZE(uint64_t instr) {
+        SETTILESIZE::SETTILESIZE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF2);
 
-            uls = instr >> (32 + 12) & 0xFFF;
-            ult = instr >> 32 & 0xFFF;
-            tile_no = instr >> 24 & 0x7;
-            lrs = instr >> 12 & 0xFFF;
-            lrt = instr & 0xFFF;
+            uls = Layout::Rect::x1::get(instr);
+            ult = Layout::Rect::y1::get(instr);
+            tile_no = Layout::Rect::tile_no::get(instr);
+            lrs = Layout::Rect::x2::get(instr);
+            lrt = Layout::Rect::y2::get(instr);
         }
 
         std::string SETTILESIZE::sid() { return "G_SETTILESIZE"; }
@@ -769,14 +1130,14 @@ namespace RCP {
 
 
 
-        LOADBLOCK::LOADBLOCK(uint64_t instr) {
+        LOADBLOCK::LOADBLOCK(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF3);
 
-            uls = instr >> (32 + 12) & 0xFFF;
-            ult = instr >> 32 & 0xFFF;
-            tile_no = instr >> 24 & 0x7;
-            last_texel_idx = instr >> 12 & 0xFFF;
-            dxt = instr & 0xFFF;
+            uls = Layout::Rect::x1::get(instr);
+            ult = Layout::Rect::y1::get(instr);
+            tile_no = Layout::Rect::tile_no::get(instr);
+            last_texel_idx = Layout::Rect::x2::get(instr);
+            dxt = Layout::Rect::y2::get(instr);
         }
 
         std::string LOADBLOCK::sid() { return "G_LOADBLOCK"; }
@@ -785,14 +1146,14 @@ namespace RCP {
 
 
 
-        LOADTILE::LOADTILE(uint64_t instr) {
+        LOADTILE::LOADTILE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF4);
 
-            uls = instr >> (32 + 12) & 0xFFF;
-            ult = instr >> 32 & 0xFFF;
-            tile_no = instr >> 24 & 0x7;
-            lrs = instr >> 12 & 0xFFF;
-            lrt = instr & 0xFFF;
+            uls = Layout::Rect::x1::get(instr);
+            ult = Layout::Rect::y1::get(instr);
+            tile_no = Layout::Rect::tile_no::get(instr);
+            lrs = Layout::Rect::x2::get(instr);
+            lrt = Layout::Rect::y2::get(instr);
         }
 
         std::string LOADTILE::sid() { return "G_LOADTILE"; }
@@ -801,77 +1162,33 @@ namespace RCP {
 
 
 
-        SETTILE::SETTILE(uint64_t instr) {
+        SETTILE::SETTILE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF5);
 
-            Image::Colors icl;
-            Image::Size isz;
+            validate<SETTILE>(instr);
 
-            switch (instr >> (32 + 21) & 0x7) {
-              case 0x00:
-                icl = Image::Colors::RGBA;
-                break;
+            tile_fmt = readFormat(instr);
 
-              case 0x01:
-                icl = Image::Colors::YUV;
-                break;
+            u64_per_row = Layout::SETTILE::u64_per_row::get(instr);
+            tmem_address = Layout::SETTILE::tmem_address::get(instr);
 
-              case 0x02:
-                icl = Image::Colors::CI;
-                break;
+            tile_no = Layout::SETTILE::tile_no::get(instr);
 
-              case 0x03:
-                icl = Image::Colors::IA;
-                break;
+            pal_no = Layout::SETTILE::pal_no::get(instr);
 
-              case 0x04:
-                icl = Image::Colors::I;
-                break;
+            clamp_T  = Layout::SETTILE::clamp_T::get(instr);
+            mirror_T = Layout::SETTILE::mirror_T::get(instr);
+            mask_T   = Layout::SETTILE::mask_T::get(instr);
+            shift_T  = Layout::SETTILE::shift_T::get(instr);
 
-              default:
-                throw X::RCP::BadCommand(sid(), instr, "Impossible color format given");
-                break;
-            }
-
-            switch (instr >> (32 + 19) & 0x3) {
-              case 0x00:
-                isz = Image::Size::u4;
-                break;
-
-              case 0x01:
-                isz = Image::Size::u8;
-                break;
-
-              case 0x02:
-                isz = Image::Size::u16;
-                break;
-
-              case 0x03:
-                isz = Image::Size::u32;
-                break;
-
-              default:
-                throw X::RCP::BadCommand(sid(), instr, "Impossible format size given");
-            }
-
-            tile_fmt = getFormat(icl, isz);
-
-            u64_per_row = instr >> (32 + 9) & 0x1FF;
-            tmem_address = instr >> 32 & 0x1FF;
-
-            tile_no = instr >> 24 & 0x7;
-
-            pal_no = instr >> 20 & 0xF;
-
-            clamp_T  = instr >> 19 & 0x1;
-            mirror_T = instr >> 18 & 0x1;
-            mask_T   = instr >> 14 & 0xF;
-            shift_T  = instr >> 10 & 0xF;
+            clamp_S  = Layout::SETTILE::clamp_S::get(instr);
+            mirror_S = Layout::SETTILE::mirror_S::get(instr);
+            mask_S   = Layout::SETTILE::mask_S::get(instr);
+            shift_S  = Layout::SETTILE::shift_S::get(instr);
+        }
 
-            clamp_S  = instr >>  9 & 0x1;
-            mirror_S = instr >>  8 & 0x1;
-            mask_S   = instr >>  4 & 0xF;
-            shift_S  = instr >>  4 & 0xF;
+        const char * SETTILE::problem(uint64_t instr) {
+            return formatProblem(instr);
         }
 
 
@@ -883,19 +1200,25 @@ namespace RCP {
 
 
 
-        FILLRECT::FILLRECT(uint64_t instr) {
+        FILLRECT::FILLRECT(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF6);
 
-            lrx = instr >> (32 + 12) & 0xFFF;
-            lry = instr >> 32 & 0xFFF;
-            ulx = instr >> 12 & 0xFFF;
-            uly = instr & 0xFFF;
+            validate<FILLRECT>(instr);
 
-            //// VALIDITY CHECK, make sure all these 10.2 numbers are integers
-            if ((lrx & 0xFFC) != lrx || (lry & 0xFFC) != lry
-             || (ulx & 0xFFC) != ulx || (uly & 0xFFC) != uly) {
-                throw X::RCP::BadCommand(sid(), instr, "Coordinates not all integers.");
+            lrx = Layout::Rect::x1::get(instr);
+            lry = Layout::Rect::y1::get(instr);
+            ulx = Layout::Rect::x2::get(instr);
+            uly = Layout::Rect::y2::get(instr);
+        }
+
+        const char * FILLRECT::problem(uint64_t instr) {
+            // make sure all these 10.2 numbers are integers
+            if (((Layout::Rect::x1::get(instr) | Layout::Rect::y1::get(instr)
+                | Layout::Rect::x2::get(instr) | Layout::Rect::y2::get(instr)) & 0x3) != 0) {
+                return "Coordinates not all integers.";
             }
+
+            return nullptr;
         }
 
         std::string FILLRECT::sid() { return "G_FILLRECT"; }
@@ -904,10 +1227,10 @@ namespace RCP {
 
 
 
-        SETFILLCOLOR::SETFILLCOLOR(uint64_t instr) {
+        SETFILLCOLOR::SETFILLCOLOR(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF7);
 
-            rawval = instr & 0xFFFFFFFF;
+            rawval = Layout::Word::get(instr);
         }
 
         std::string SETFILLCOLOR::sid() { return "G_SETFILLCOLOR"; }
@@ -916,13 +1239,13 @@ namespace RCP {
 
 
 
-        SETFOGCOLOR::SETFOGCOLOR(uint64_t instr) {
+        SETFOGCOLOR::SETFOGCOLOR(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF8);
 
-            R = instr >> 24 & 0xFF;
-            G = instr >> 16 & 0xFF;
-            B = instr >>  8 & 0xFF;
-            A = instr       & 0xFF;
+            R = Layout::Color::R::get(instr);
+            G = Layout::Color::G::get(instr);
+            B = Layout::Color::B::get(instr);
+            A = Layout::Color::A::get(instr);
         }
 
         std::string SETFOGCOLOR::sid() { return "G_SETFOGCOLOR"; }
@@ -931,13 +1254,13 @@ namespace RCP {
 
 
 
-        SETBLENDCOLOR::SETBLENDCOLOR(uint64_t instr) {
+        SETBLENDCOLOR::SETBLENDCOLOR(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xF9);
 
-            R = instr >> 24 & 0xFF;
-            G = instr >> 16 & 0xFF;
-            B = instr >>  8 & 0xFF;
-            A = instr       & 0xFF;
+            R = Layout::Color::R::get(instr);
+            G = Layout::Color::G::get(instr);
+            B = Layout::Color::B::get(instr);
+            A = Layout::Color::A::get(instr);
         }
 
         std::string SETBLENDCOLOR::sid() { return "G_SETBLENDCOLOR"; }
@@ -946,16 +1269,16 @@ namespace RCP {
 
 
 
-        SETPRIMCOLOR::SETPRIMCOLOR(uint64_t instr) {
+        SETPRIMCOLOR::SETPRIMCOLOR(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xFA);
 
-            min_lod = instr >> (32 + 8) & 0xFF;
-            lod_frac = instr >> 32 & 0xFF;
+            min_lod = Layout::SETPRIMCOLOR::min_lod::get(instr);
+            lod_frac = Layout::SETPRIMCOLOR::lod_frac::get(instr);
 
-            R = instr >> 24 & 0xFF;
-            G = instr >> 16 & 0xFF;
-            B = instr >>  8 & 0xFF;
-            A = instr       & 0xFF;
+            R = Layout::Color::R::get(instr);
+            G = Layout::Color::G::get(instr);
+            B = Layout::Color::B::get(instr);
+            A = Layout::Color::A::get(instr);
         }
 
         std::string SETPRIMCOLOR::sid() { return "G_SETPRIMCOLOR"; }
@@ -964,13 +1287,13 @@ namespace RCP {
 
 
 
-        SETENVCOLOR::SETENVCOLOR(uint64_t instr) {
+        SETENVCOLOR::SETENVCOLOR(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xFB);
 
-            R = instr >> 24 & 0xFF;
-            G = instr >> 16 & 0xFF;
-            B = instr >>  8 & 0xFF;
-            A = instr       & 0xFF;
+            R = Layout::Color::R::get(instr);
+            G = Layout::Color::G::get(instr);
+            B = Layout::Color::B::get(instr);
+            A = Layout::Color::A::get(instr);
         }
 
         std::string SETENVCOLOR::sid() { return "G_SETENVCOLOR"; }
@@ -979,37 +1302,37 @@ namespace RCP {
 
 
 
-        SETCOMBINE::SETCOMBINE(uint64_t instr) {
+        SETCOMBINE::SETCOMBINE(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xFC);
 
             // this is the only place we static_cast enum values, despite
             // potentially leading to unnamed values, since writing it all out
             // would be prohibitively insane.
 
-            color_1a = static_cast<CC::ColorA>(std::min(instr >> (32 + 20) &  0xF,  0x08uL));
-            color_1c = static_cast<CC::ColorC>(std::min(instr >> (32 + 15) & 0x1F,  0x10uL));
+            color_1a = static_cast<CC::ColorA>(std::min(Layout::SETCOMBINE::color_1a::get(instr), 0x08u));
+            color_1c = static_cast<CC::ColorC>(std::min(Layout::SETCOMBINE::color_1c::get(instr), 0x10u));
 
-            alpha_1a = static_cast<CC::AlphaA>(std::min(instr >> (32 + 12) &  0x7,  0x07uL));
-            alpha_1c = static_cast<CC::AlphaC>(std::min(instr >> (32 +  9) &  0x7,  0x07uL));
+            alpha_1a = static_cast<CC::AlphaA>(std::min(Layout::SETCOMBINE::alpha_1a::get(instr), 0x07u));
+            alpha_1c = static_cast<CC::AlphaC>(std::min(Layout::SETCOMBINE::alpha_1c::get(instr), 0x07u));
 
-            color_2a = static_cast<CC::ColorA>(std::min(instr >> (32 +  5) &  0xF,  0x08uL));
-            color_2c = static_cast<CC::ColorC>(std::min(instr >> 32        & 0x1F,  0x10uL));
+            color_2a = static_cast<CC::ColorA>(std::min(Layout::SETCOMBINE::color_2a::get(instr), 0x08u));
+            color_2c = static_cast<CC::ColorC>(std::min(Layout::SETCOMBINE::color_2c::get(instr), 0x10u));
 
-            color_1b = static_cast<CC::ColorB>(std::min(instr >> 28        &  0xF,  0x08uL));
-            color_2b = static_cast<CC::ColorB>(std::min(instr >> 24        &  0xF,  0x08uL));
+            color_1b = static_cast<CC::ColorB>(std::min(Layout::SETCOMBINE::color_1b::get(instr), 0x08u));
+            color_2b = static_cast<CC::ColorB>(std::min(Layout::SETCOMBINE::color_2b::get(instr), 0x08u));
 
-            alpha_2a = static_cast<CC::AlphaA>(std::min(instr >> 21        &  0x7,  0x07uL));
-            alpha_2c = static_cast<CC::AlphaC>(std::min(instr >> 18        &  0x7,  0x07uL));
+            alpha_2a = static_cast<CC::AlphaA>(std::min(Layout::SETCOMBINE::alpha_2a::get(instr), 0x07u));
+            alpha_2c = static_cast<CC::AlphaC>(std::min(Layout::SETCOMBINE::alpha_2c::get(instr), 0x07u));
 
-            color_1d = static_cast<CC::ColorD>(std::min(instr >> 15        &  0x7,  0x07uL));
+            color_1d = static_cast<CC::ColorD>(std::min(Layout::SETCOMBINE::color_1d::get(instr), 0x07u));
 
-            alpha_1b = static_cast<CC::AlphaB>(std::min(instr >> 12        &  0x7,  0x07uL));
-            alpha_1d = static_cast<CC::AlphaD>(std::min(instr >>  9        &  0x7,  0x07uL));
+            alpha_1b = static_cast<CC::AlphaB>(std::min(Layout::SETCOMBINE::alpha_1b::get(instr), 0x07u));
+            alpha_1d = static_cast<CC::AlphaD>(std::min(Layout::SETCOMBINE::alpha_1d::get(instr), 0x07u));
 
-            color_2d = static_cast<CC::ColorD>(std::min(instr >>  6        &  0x7,  0x07uL));
+            color_2d = static_cast<CC::ColorD>(std::min(Layout::SETCOMBINE::color_2d::get(instr), 0x07u));
 
-            alpha_2b = static_cast<CC::AlphaB>(std::min(instr >>  3        &  0x7,  0x07uL));
-            alpha_2d = static_cast<CC::AlphaD>(std::min(instr              &  0x7,  0x07uL));
+            alpha_2b = static_cast<CC::AlphaB>(std::min(Layout::SETCOMBINE::alpha_2b::get(instr), 0x07u));
+            alpha_2d = static_cast<CC::AlphaD>(std::min(Layout::SETCOMBINE::alpha_2d::get(instr), 0x07u));
         }
 
         std::string SETCOMBINE::sid() { return "G_SETCOMBINE"; }
@@ -1018,66 +1341,28 @@ namespace RCP {
 
 
 
-        SETTIMG::SETTIMG(uint64_t instr) {
+        SETTIMG::SETTIMG(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xFD);
 
-            Image::Colors icl;
-            Image::Size isz;
-
-            switch (instr >> (32 + 21) & 0x7) {
-              case 0x00:
-                icl = Image::Colors::RGBA;
-                break;
-
-              case 0x01:
-                icl = Image::Colors::YUV;
-                break;
-
-              case 0x02:
-                icl = Image::Colors::CI;
-                break;
+            validate<SETTIMG>(instr);
 
-              case 0x03:
-                icl = Image::Colors::IA;
-                break;
+            tile_fmt    = readFormat(instr);
+            width       = Layout::SETIMG::width_less_one::get(instr) + 1;
+            ram_address = Layout::Word::get(instr);
+        }
 
-              case 0x04:
-                icl = Image::Colors::I;
-                break;
+        const char * SETTIMG::problem(uint64_t instr) {
+            const char * why = formatProblem(instr);
 
-              default:
-                throw X::RCP::BadCommand(sid(), instr, "Impossible color format given");
-                break;
+            if (why != nullptr) {
+                return why;
             }
 
-            switch (instr >> (32 + 19) & 0x3) {
-              case 0x00:
-                isz = Image::Size::u4;
-                break;
-
-              case 0x01:
-                isz = Image::Size::u8;
-                break;
-
-              case 0x02:
-                isz = Image::Size::u16;
-                break;
-
-              case 0x03:
-                isz = Image::Size::u32;
-                break;
-
-              default:
-                throw X::RCP::BadCommand(sid(), instr, "Impossible format size given");
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Bad segment for segment address";
             }
 
-            tile_fmt    = getFormat(icl, isz);
-            width       = (instr >> 32 & 0xFFF) + 1;
-            ram_address = instr & 0xFFFFFFFF;
-
-            if ((ram_address >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Bad segment for segment address");
-            }
+            return nullptr;
         }
 
         std::string SETTIMG::sid() { return "G_SETTIMG"; }
@@ -1086,243 +1371,91 @@ namespace RCP {
 
 
 
-        SETZIMG::SETZIMG(uint64_t instr) {
+        SETZIMG::SETZIMG(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xFE);
 
-            ram_address = instr & 0xFFFFFFFF;
+            validate<SETZIMG>(instr);
 
-            if ((ram_address >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Bad segment for segment address");
+            ram_address = Layout::Word::get(instr);
+        }
+
+        const char * SETZIMG::problem(uint64_t instr) {
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Bad segment for segment address";
             }
+
+            return nullptr;
         }
 
         std::string SETZIMG::sid() { return "G_SETZIMG"; }
-        std::string SETZIMG::id() { return id(); }
+        std::string SETZIMG::id() { return sid(); }
 
 
 
 
-        SETCIMG::SETCIMG(uint64_t instr) {
+        SETCIMG::SETCIMG(uint64_t instr) : Any(KIND) {
             assert(instr >> 56 == 0xFF);
 
-            Image::Colors icl;
-            Image::Size isz;
-
-            switch (instr >> (32 + 21) & 0x7) {
-              case 0x00:
-                icl = Image::Colors::RGBA;
-                break;
-
-              case 0x01:
-                icl = Image::Colors::YUV;
-                break;
-
-              case 0x02:
-                icl = Image::Colors::CI;
-                break;
+            validate<SETCIMG>(instr);
 
-              case 0x03:
-                icl = Image::Colors::IA;
-                break;
+            tile_fmt    = readFormat(instr);
+            width       = Layout::SETIMG::width_less_one::get(instr) + 1;
+            ram_address = Layout::Word::get(instr);
+        }
 
-              case 0x04:
-                icl = Image::Colors::I;
-                break;
+        const char * SETCIMG::problem(uint64_t instr) {
+            const char * why = formatProblem(instr);
 
-              default:
-                throw X::RCP::BadCommand(sid(), instr, "Impossible color format given");
-                break;
+            if (why != nullptr) {
+                return why;
             }
 
-            switch (instr >> (32 + 19) & 0x3) {
-              case 0x00:
-                isz = Image::Size::u4;
-                break;
-
-              case 0x01:
-                isz = Image::Size::u8;
-                break;
-
-              case 0x02:
-                isz = Image::Size::u16;
-                break;
-
-              case 0x03:
-                isz = Image::Size::u32;
-                break;
-
-              default:
-                throw X::RCP::BadCommand(sid(), instr, "Impossible format size given");
+            if (Layout::Segment::get(instr) > 0x0F) {
+                return "Bad segment for segment address";
             }
 
-            tile_fmt    = getFormat(icl, isz);
-            width       = (instr >> 32 & 0xFFF) + 1;
-            ram_address = instr & 0xFFFFFFFF;
-
-            if ((ram_address >> 24) > 0x0F) {
-                throw X::RCP::BadCommand(sid(), instr, "Bad segment for segment address");
-            }
+            return nullptr;
         }
 
         std::string SETCIMG::sid() { return "G_SETCIMG"; }
         std::string SETCIMG::id() { return sid(); }
     }
 
-    Command::Any * parseOneCmd(uint64_t cmd) {
-        // we use bitmasking to match commands so we have a better
-        // chance of weeding out false positives. Mask out the variable
-        // parts of a command, see if it still matches.
-        if ((cmd & ~0x00000000FFFFFFFFuLL) == 0x0000000000000000uLL) {
-            return new Command::NOOP(cmd);
-
-        } else if ((cmd & ~0x000FF0FFFFFFFFFFuLL) == 0x0100000000000000uLL) {
-            return new Command::VTX(cmd);
-
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0x0200000000000000uLL) {
-            return new Command::MODIFYVTX(cmd);
-
-        } else if ((cmd & ~0x0000FFFF0000FFFFuLL) == 0x0300000000000000uLL) {
-            return new Command::CULLDL(cmd);
-
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0x0400000000000000uLL) {
-            return new Command::BRANCH_Z(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF00000000uLL) == 0x0500000000000000uLL) {
-            return new Command::TRI1(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF00FFFFFFuLL) == 0x0600000000000000uLL) {
-            return new Command::TRI2(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF00FFFFFFuLL) == 0x0700000000000000uLL) {
-            return new Command::QUAD(cmd);
-
-        } else if ((cmd & ~0x00FFEFFFFFFFFFFFuLL) == 0xD600000000000000uLL) {
-            return new Command::DMA_IO(cmd);
-
-        } else if ((cmd & ~0x00003FFFFFFFFFFFuLL) == 0xD700000000000000uLL) {
-            return new Command::TEXTURE(cmd);
-
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xD838000200000000uLL) {
-            return new Command::POPMTX(cmd);
-
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0xD900000000000000uLL) {
-            return new Command::GEOMETRYMODE(cmd);
-
-        } else if ((cmd & ~0x000000FFFFFFFFFFuLL) == 0xDA38000000000000uLL) {
-            return new Command::MTX(cmd);
-
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0xDB00000000000000uLL) {
-            return new Command::MOVEWORD(cmd);
+    bool parseOneCmd(uint64_t cmd, Command::Kind & kind) {
+        // we use bitmasking to match commands so we have a better chance of
+        // weeding out false positives; see shapeOf()
+        const OpcodeShape * shape = matchShape(cmd);
 
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0xDC00000000000000uLL) {
-            return new Command::MOVEMEM(cmd);
-
-        } else if ((cmd & ~0x0000FFFFFFFFFFFFuLL) == 0xDD00000000000000uLL) {
-            return new Command::LOAD_UCODE(cmd);
-
-        } else if ((cmd & ~0x00FF0000FFFFFFFFuLL) == 0xDE00000000000000uLL) {
-            return new Command::DL(cmd);
-        } else if (cmd == 0xDF00000000000000uLL) {
-            return new Command::ENDDL(cmd);
-        } else if (cmd == 0xE000000000000000uLL) {
-            return new Command::SPNOOP(cmd);
-
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xE100000000000000uLL) {
-            return new Command::RDPHALF_1(cmd);
-
-        } else if ((cmd & ~0x0000FFFFFFFFFFFFuLL) == 0xE200000000000000uLL) {
-            return new Command::SETOTHERMODE_L(cmd);
-
-        } else if ((cmd & ~0x0000FFFFFFFFFFFFuLL) == 0xE300000000000000uLL) {
-            return new Command::SETOTHERMODE_H(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF07FFFFFFuLL) == 0xE400000000000000uLL) {
-            return new Command::TEXRECT(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF07FFFFFFuLL) == 0xE500000000000000uLL) {
-            return new Command::TEXRECTFLIP(cmd);
-
-        } else if (cmd == 0xE600000000000000uLL) {
-            return new Command::RDPLOADSYNC(cmd);
-
-        } else if (cmd == 0xE700000000000000uLL) {
-            return new Command::RDPPIPESYNC(cmd);
-
-        } else if (cmd == 0xE800000000000000uLL) {
-            return new Command::RDPTILESYNC(cmd);
-
-        } else if (cmd == 0xE900000000000000uLL) {
-            return new Command::RDPFULLSYNC(cmd);
-
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0xEA00000000000000uLL) {
-            return new Command::SETKEYGB(cmd);
-
-        } else if ((cmd & ~0x000000000FFFFFFFuLL) == 0xEB00000000000000uLL) {
-            return new Command::SETKEYR(cmd);
-
-        } else if ((cmd & ~0x003FFFFFFFFFFFFFuLL) == 0xEC00000000000000uLL) {
-            return new Command::SETCONVERT(cmd);
-
-        } else if ((cmd & ~0x00FFFFFFF0FFFFFFuLL) == 0xED00000000000000uLL) {
-            return new Command::SETSCISSOR(cmd);
-
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xEE00000000000000uLL) {
-            return new Command::SETPRIMDEPTH(cmd);
-
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0xEF00000000000000uLL) {
-            return new Command::RDPSETOTHERMODE(cmd);
-
-        } else if ((cmd & ~0x0000000007FFF000uLL) == 0xF000000000000000uLL) {
-            return new Command::LOADTLUT(cmd);
-
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xF100000000000000uLL) {
-            return new Command::RDPHALF_2(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF07FFFFFFuLL) == 0xF200000000000000uLL) {
-            return new Command::SETTILESIZE(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF07FFFFFFuLL) == 0xF300000000000000uLL) {
-            return new Command::LOADBLOCK(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF07FFFFFFuLL) == 0xF400000000000000uLL) {
-            return new Command::LOADTILE(cmd);
-
-        } else if ((cmd & ~0x00FBFFFF07FFFFFFuLL) == 0xF500000000000000uLL) {
-            return new Command::SETTILE(cmd);
-
-        } else if ((cmd & ~0x00FFFFFF00FFFFFFuLL) == 0xF600000000000000uLL) {
-            return new Command::FILLRECT(cmd);
-
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xF700000000000000uLL) {
-            return new Command::SETFILLCOLOR(cmd);
-
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xF800000000000000uLL) {
-            return new Command::SETFOGCOLOR(cmd);
-
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xF900000000000000uLL) {
-            return new Command::SETBLENDCOLOR(cmd);
-
-        } else if ((cmd & ~0x0000FFFFFFFFFFFFuLL) == 0xFA00000000000000uLL) {
-            return new Command::SETPRIMCOLOR(cmd);
+        if (shape == nullptr) {
+            return false;
+        }
 
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xFB00000000000000uLL) {
-            return new Command::SETENVCOLOR(cmd);
+        const char * why = shape->problem != nullptr ? shape->problem(cmd) : nullptr;
 
-        } else if ((cmd & ~0x00FFFFFFFFFFFFFFuLL) == 0xFC00000000000000uLL) {
-            return new Command::SETCOMBINE(cmd);
+        if (why != nullptr) {
+            throw X::RCP::BadCommand(shape->name, cmd, why);
+        }
 
-        } else if ((cmd & ~0x00F80FFFFFFFFFFFuLL) == 0xFD00000000000000uLL) {
-            return new Command::SETTIMG(cmd);
+        kind = shape->kind;
+        return true;
+    }
 
-        } else if ((cmd & ~0x00000000FFFFFFFFuLL) == 0xFE00000000000000uLL) {
-            return new Command::SETZIMG(cmd);
+    const char * Instruction::name() const {
+        return opcodeShape(word >> 56).name;
+    }
 
-        } else if ((cmd & ~0x00F80FFFFFFFFFFFuLL) == 0xFF00000000000000uLL) {
-            return new Command::SETCIMG(cmd);
+    const char * kindName(Command::Kind kind) {
+        // only G_QUAD shares a kind, and it goes by G_TRI2 too, so the first
+        // opcode found will do
+        for (size_t op = 0; op < 256; op++) {
+            const OpcodeShape & shape = opcodeShape(op);
 
-        } else {
-            return nullptr;
+            if (shape.known && shape.kind == kind) {
+                return shape.name;
+            }
         }
+
+        return "(unknown)";
     }
 }
 
@@ -80,6 +80,26 @@ namespace RCP {
             throw X::RCP::Image::NoSuchFormat();
         }
 
+        bool hasFormat(Colors c, Size s) {
+            switch (c) {
+              case Colors::RGBA:
+                return s == Size::u16 || s == Size::u32;
+                break;
+
+              case Colors::YUV:
+                return s == Size::u16;
+                break;
+
+              case Colors::CI:
+              case Colors::IA:
+              case Colors::I:
+                return s != Size::u32;
+                break;
+            }
+
+            return false;
+        }
+
         Colors getColors(Format f) {
             switch (f) {
               case Format::RGBA_16:
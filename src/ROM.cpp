@@ -6,14 +6,20 @@
 
 #include "ROM.hpp"
 #include "endian.hpp"
+#include "byteswap.hpp"
+#include "bytesearch.hpp"
+#include "ROMCRC.hpp"
+#include "ROMIndexCache.hpp"
+#include "hash.hpp"
 #include "yaz0.hpp"
 #include "Exceptions.hpp"
-
-#include <QString>
+#include "Parallel.hpp"
 
 #include <algorithm>
+#include <mutex>
 #include <iostream>
 #include <array>
+#include <stdexcept>
 
 namespace ROM {
     bool Record::isCompressed() const { return pend != 0 && !isMissing(); }
@@ -31,17 +37,30 @@ namespace ROM {
         return vend - vstart;
     }
 
-    File::File(const std::vector<uint8_t> & fd, const Record & fa) : fileData(fd),
-                                                                     foundAt(fa) { }
+    File::File(std::shared_ptr<const uint8_t> fd, size_t fs, const Record & fa) : fileData(fd),
+                                                                                  fileSize(fs),
+                                                                                  foundAt(fa) { }
+
+    File::File(std::vector<uint8_t> fd, const Record & fa) : fileSize(fd.size()), foundAt(fa) {
+        auto buf = std::make_shared<const std::vector<uint8_t>>(std::move(fd));
+
+        fileData = std::shared_ptr<const uint8_t>(buf, buf->data());
+    }
 
     Record File::record() const { return foundAt; }
-    size_t File::size() const { return fileData.size(); }
+    size_t File::size() const { return fileSize; }
 
-    uint8_t File::at(size_t idx) const { return fileData.at(idx); }
+    uint8_t File::at(size_t idx) const {
+        if (idx >= fileSize) {
+            throw std::out_of_range("File::at");
+        }
+
+        return fileData.get()[idx];
+    }
 
     File File::decompress() const {
         if (foundAt.isCompressed() && !decompressed) {
-            File res(yaz0_decompress(fileData), foundAt);
+            File res(yaz0_decompress(data(), size()), foundAt);
             res.decompressed = true;
             return res;
         } else {
@@ -49,49 +68,254 @@ namespace ROM {
         }
     }
 
-    std::vector<uint8_t> File::getData() const { return fileData; }
+    std::vector<uint8_t> File::peek(size_t count) const {
+        if (foundAt.isCompressed() && !decompressed) {
+            Yaz0Stream dec(data(), size());
+
+            std::vector<uint8_t> res(std::min(count, dec.size()));
+            dec.read(res.data(), res.size());
+
+            return res;
+        }
+
+        return std::vector<uint8_t>(begin(), begin() + std::min(count, fileSize));
+    }
+
+    std::vector<uint8_t> File::getData() const { return std::vector<uint8_t>(begin(), end()); }
 
-    std::vector<uint8_t>::iterator File::begin() { return fileData.begin(); }
-    std::vector<uint8_t>::iterator File::end() { return fileData.end(); }
+    const uint8_t * File::data() const { return fileData.get(); }
 
-    ROM::ROM(std::vector<uint8_t> rfile) : rawData(rfile) {
-        // first we want to find "zelda@", or for a byteswapped ROM "ezdl@a"
+    const uint8_t * File::begin() const { return fileData.get(); }
+    const uint8_t * File::end() const { return fileData.get() + fileSize; }
 
-        // note that this method currently penalizes a byteswapped ROM, but
-        // that's fair considering byteswapping is dumb.
+    OpenMonitor::OpenMonitor(std::function<void(OpenStage)> os) : onStage(os), cancelled(false) { }
 
-        std::string curmagic = "zelda@";
+    void OpenMonitor::cancel() { cancelled = true; }
+    bool OpenMonitor::isCancelled() const { return cancelled; }
 
-        auto magicptr = std::search(rawData.begin(), rawData.end(),
-                                    curmagic.begin(), curmagic.end());
+    void OpenMonitor::reached(OpenStage s) {
+        if (cancelled) {
+            throw X::ROM::Cancelled();
+        }
 
-        if (magicptr == rawData.end()) {
-            curmagic = "ezdl@a";
-            magicptr = std::search(rawData.begin(), rawData.end(),
-                                   curmagic.begin(), curmagic.end());
+        if (onStage) {
+            onStage(s);
         }
+    }
 
-        if (magicptr == rawData.end()) {
-            throw X::ROM::NoMagic();
+    ByteOrder detectByteOrder(const uint8_t * rdata, size_t rsize) {
+        if (rsize < 4) {
+            return ByteOrder::BIG;
+        }
+
+        // the first word of the header is always 0x80371240
+        uint32_t first = be_u32(rdata);
+
+        switch (first) {
+          case 0x37804012:
+            return ByteOrder::SWAPPED_16;
+            break;
+
+          case 0x40123780:
+            return ByteOrder::SWAPPED_32;
+            break;
+
+          default:
+            return ByteOrder::BIG;
+            break;
+        }
+    }
+
+    ROM::ROM(std::shared_ptr<Source> src, const std::string & indexDir, OpenMonitor * mon) : rawData(src) {
+        auto reached = [mon](OpenStage s) {
+            if (mon != nullptr) {
+                mon->reached(s);
+            }
+        };
+
+        // first get the data in the right order, if the header tells us it
+        // isn't.
+        reached(OpenStage::UNSWAPPING);
+
+        origOrder = detectByteOrder(rawData->data(), rawData->size());
+
+        if (origOrder != ByteOrder::BIG) {
+            unByteSwap(origOrder);
+        }
+
+        // if we've seen this ROM before, the cache has everything else
+        CachedIndex cached;
+
+        if (!indexDir.empty() && rawData->size() >= CRCState::END) {
+            reached(OpenStage::CACHE);
+
+            cached.romSize = rawData->size();
+            cached.headerCRC = getCRC();
+
+            if (IndexCache(indexDir).load(cached.romSize, cached.headerCRC, cached)
+                && adoptIndex(cached)) {
+                reached(OpenStage::DONE);
+                return;
+            }
         }
 
-        if (curmagic == "ezdl@a") {
-            // let's un-byteswap and mark that it was
-            wasBS = true;
-            unByteSwap();
+        reached(OpenStage::IDENTIFYING);
+
+        // then we want to find "zelda@"
+        const uint8_t * magicptr = findMagic();
+
+        // a dump with a mangled header could still be byteswapped, which
+        // would make the string "ezdl@a". This penalizes such ROMs with a
+        // second search, but that's fair considering byteswapping is dumb.
+        if (magicptr == nullptr && origOrder == ByteOrder::BIG) {
+            const uint8_t bsmagic[] = {'e', 'z', 'd', 'l', '@', 'a'};
+
+            const uint8_t * rbegin = rawData->data();
+            const uint8_t * rend = rbegin + rawData->size();
+
+            if (findBytes(rbegin, rend - rbegin, bsmagic, sizeof(bsmagic)) != rend) {
+                origOrder = ByteOrder::SWAPPED_16;
+                unByteSwap(origOrder);
+
+                magicptr = findMagic();
+            }
         }
 
+        if (magicptr == nullptr) {
+            throw X::ROM::NoMagic();
+        }
+
+        const uint8_t * rbegin = rawData->data();
+
         // now we can bootstrap the version with the compile timestamp
-        bootstrapCompTime(magicptr - rawData.begin());
+        bootstrapCompTime(magicptr - rbegin);
 
         // and then the TOC
-        bootstrapTOC(magicptr - rawData.begin() + 0x30);
+        reached(OpenStage::READING_TOC);
+
+        bootstrapTOC(magicptr - rbegin + 0x30);
+
+        reached(OpenStage::NAMING);
+
+        nameFiles();
+
+        // the CRC and file hashes aren't saved; working them out takes as
+        // long as checking them against the whole ROM would, so they're left
+        // for whoever first wants them, cache or not.
+        size_t headEnd = tocEnd(fileList, tocOffset, rawData->size());
+
+        if (!indexDir.empty() && cached.romSize != 0 && headEnd != 0) {
+            reached(OpenStage::SAVING);
+
+            cached.headHash = hash64(rawData->data(), headEnd);
+            cached.origOrder = origOrder;
+            cached.rver = rver;
+            cached.configStamp = configStamp(rver);
+            cached.tocOffset = tocOffset;
+            cached.fileList = fileList;
+
+            IndexCache(indexDir).save(cached);
+        }
+
+        reached(OpenStage::DONE);
     }
 
-    void ROM::unByteSwap() {
-        for (auto i = rawData.begin(); i < rawData.end(); i+=2) {
-            std::swap(*i, *(i + 1));
+    bool ROM::adoptIndex(CachedIndex & idx) {
+        // anything past here indexes the data by the cached TOC, so it had
+        // better be one that fits
+        size_t headEnd = tocEnd(idx.fileList, idx.tocOffset, rawData->size());
+
+        if (headEnd == 0) {
+            return false;
+        }
+
+        // the header and CRC pair we looked the entry up by were read after
+        // fixing the byte order the header told us about, so the only
+        // difference there can be is the mangled header case, where we found
+        // out later it was swapped after all. The head was hashed with the
+        // order fixed, so check a swapped copy before swapping the lot.
+        bool swap = idx.origOrder != origOrder;
+
+        if (swap && (origOrder != ByteOrder::BIG || idx.origOrder != ByteOrder::SWAPPED_16)) {
+            return false;
         }
+
+        if (swap) {
+            std::vector<uint8_t> head(rawData->data(), rawData->data() + headEnd);
+            byteswap16(head.data(), head.size());
+
+            if (hash64(head.data(), head.size()) != idx.headHash) {
+                return false;
+            }
+
+            origOrder = idx.origOrder;
+            unByteSwap(origOrder);
+        } else if (hash64(rawData->data(), headEnd) != idx.headHash) {
+            return false;
+        }
+
+        rver = idx.rver;
+        ctree = getConfigTree(rver);
+
+        tocOffset = idx.tocOffset;
+        fileList = std::move(idx.fileList);
+
+        buildIndexes();
+
+        return true;
+    }
+
+    const uint8_t * ROM::findMagic() const {
+        const uint8_t magic[] = {'z', 'e', 'l', 'd', 'a', '@'};
+
+        const uint8_t * rbegin = rawData->data();
+        size_t rsize = rawData->size();
+
+        // unmodified ROMs of every version we know have the build string in
+        // a known place, so check those first; then opening a ROM doesn't
+        // take longer the bigger it is.
+        for (int v = static_cast<int>(Config::Version::OOT_NTSC_1_0);
+             v <= static_cast<int>(Config::Version::MM_DEBUG); v++) {
+            size_t at = Config::tocOffset(static_cast<Config::Version>(v)) - 0x30;
+
+            if (at + sizeof(magic) <= rsize && std::equal(magic, magic + sizeof(magic), rbegin + at)) {
+                return rbegin + at;
+            }
+        }
+
+        // otherwise it's something we don't know (or a hack), so go looking
+        const uint8_t * found = findBytes(rbegin, rsize, magic, sizeof(magic));
+
+        return found == rbegin + rsize ? nullptr : found;
+    }
+
+    ROM::ROM(std::vector<uint8_t> rfile) : ROM(std::make_shared<Source>(std::move(rfile))) { }
+
+    void ROM::unByteSwap(ByteOrder from) {
+        // we can't swap a read-only mapping in place, so get our own copy first
+        uint8_t * wdata = rawData->makePrivate();
+
+        if (from == ByteOrder::SWAPPED_16) {
+            byteswap16(wdata, rawData->size());
+        } else if (from == ByteOrder::SWAPPED_32) {
+            byteswap32(wdata, rawData->size());
+        }
+    }
+
+    FileNames fileNamesFor(const ConfigTree & ct) {
+        if (ct.isEmpty()) {
+            return FileNames();
+        }
+
+        // real names take priority over made-up ones, and emplace leaves
+        // existing entries alone, so add the real ones first.
+        FileNames names = ct.numericValueKeys({"fileList"});
+
+        for (auto & i : ct.numericValueKeys({"fileList", "fakeNames"})) {
+            names.emplace(i.first, i.second);
+        }
+
+        return names;
     }
 
     void ROM::bootstrapTOC(size_t firstEntry) {
@@ -99,11 +323,14 @@ namespace ROM {
         // definite file, instead of waiting until we run into something that
         // doesn't look like a file record.
 
-        auto fpoint = rawData.begin() + firstEntry;
+        const uint8_t * rbegin = rawData->data();
+        const uint8_t * rend = rbegin + rawData->size();
 
-        Record tocrec;
+        auto fpoint = rbegin + firstEntry;
 
-        while (fpoint < rawData.end()) {
+        Record tocrec = Record();
+
+        while (rend - fpoint >= 16) {
             tocrec.vstart = be_u32(fpoint); fpoint += 4;
             tocrec.vend   = be_u32(fpoint); fpoint += 4;
             tocrec.pstart = be_u32(fpoint); fpoint += 4;
@@ -126,62 +353,96 @@ namespace ROM {
             throw X::BadROM("The table of contents appears to be 'missing' in its own list, despite being present enough for us to find it. This contradiction probably isn't the only one, and in any case must be fixed before we'll touch it.");
         }
 
-        std::vector<uint8_t> tocList;
+        if (tocrec.psize() > rawData->size() - firstEntry) {
+            throw X::BadROM("The table of contents claims to extend past the end of the ROM.");
+        }
 
-        fpoint = rawData.begin() + firstEntry;
+        tocOffset = firstEntry;
 
-        std::copy(fpoint, fpoint + tocrec.psize(), std::back_inserter(tocList));
+        // now we go through the toc file (right in the ROM data, no need to
+        // copy it out first) and collect those entries
 
-        // now we go through the toc file and collect those entries
+        const uint8_t * tocBegin = rbegin + firstEntry;
+        const uint8_t * tocEnd = tocBegin + (tocrec.psize() & ~size_t(0xF));
 
-        bool canName = !ctree.isEmpty();
+        fileList.reserve(tocrec.psize() / 16);
 
-        for (auto i = tocList.begin(); i < tocList.end();) {
+        for (auto i = tocBegin; i < tocEnd;) {
             Record rr;
             rr.vstart = be_u32(i); i += 4;
             rr.vend   = be_u32(i); i += 4;
             rr.pstart = be_u32(i); i += 4;
             rr.pend   = be_u32(i); i += 4;
 
-            if (canName) {
-                try {
-                    rr.fname = ctree.findKey({"fileList"}, QString("0x%1").arg(
-                                                 QString("%1").arg(rr.vstart, 8, 16, QChar('0')).toUpper()).toStdString());
-                } catch (...) {
-                    try {
-                        rr.fname = ctree.findKey({"fileList", "fakeNames"}, QString("0x%1").arg(
-                                                     QString("%1").arg(rr.vstart, 8, 16, QChar('0')).toUpper()).toStdString());
-                    } catch (...) {
-                        rr.fname = "";
-                    }
-                }
-            } else {
-                rr.fname = "";
+            fileList.push_back(rr);
+        }
+    }
+
+    void ROM::nameFiles() {
+        FileNames names = fileNamesFor(ctree);
+
+        for (auto & rr : fileList) {
+            auto named = names.find(rr.vstart);
+
+            if (named != names.end()) {
+                rr.fname = named->second;
             }
+        }
 
-            fileList.push_back(rr);
+        buildIndexes();
+    }
+
+    void ROM::buildIndexes() {
+        vstartIndex.reserve(fileList.size());
+        nameIndex.reserve(fileList.size());
+        rangeIndex.reserve(fileList.size());
+
+        for (size_t i = 0; i < fileList.size(); i++) {
+            const Record & r = fileList[i];
+
+            // emplace doesn't replace existing entries, so the first record
+            // with a given key wins, like a front-to-back search would find.
+            vstartIndex.emplace(r.vstart, i);
+
+            if (!r.fname.empty()) {
+                nameIndex.emplace(r.fname, i);
+            }
+
+            if (r.vend > r.vstart) {
+                rangeIndex.emplace_back(r.vstart, i);
+            }
         }
+
+        std::stable_sort(rangeIndex.begin(), rangeIndex.end(),
+                         [](const std::pair<uint32_t, size_t> & a, const std::pair<uint32_t, size_t> & b) {
+                             return a.first < b.first;
+                         });
     }
 
-    bool ROM::wasByteswapped() const { return wasBS; }
+    bool ROM::wasByteswapped() const { return origOrder != ByteOrder::BIG; }
+
+    ByteOrder ROM::originalByteOrder() const { return origOrder; }
 
     size_t ROM::numFiles() const { return fileList.size(); }
 
-    Record ROM::recordAtNum(size_t idx) const {
+    const Record & ROM::recordAtNum(size_t idx) const {
         return fileList.at(idx);
     }
 
     Record ROM::recordAtVAddress(size_t addr) const {
-        auto theRecord = std::find_if(fileList.begin(), fileList.end(),
-                                      [&](const Record & a) {
-                                          return a.vstart == addr;
-                                      });
+        // the index is keyed by 32-bit addresses, which a bigger one would
+        // only get truncated to
+        if (addr > 0xFFFF'FFFF) {
+            throw X::BadIndex("virtual address, past 32 bits");
+        }
+
+        auto theRecord = vstartIndex.find(addr);
 
-        if (theRecord == fileList.end()) {
+        if (theRecord == vstartIndex.end()) {
             throw X::BadIndex("virtual address, not matching any files' starting positions");
         }
 
-        return *theRecord;
+        return fileList[theRecord->second];
     }
 
     Record ROM::recordAtName(std::string name) const {
@@ -193,21 +454,40 @@ namespace ROM {
             throw X::NoConfig("Finding files by name");
         }
 
-        auto theRecord = std::find_if(fileList.begin(), fileList.end(),
-                                      [&](const Record & a) {
-                                          return a.fname == name;
-                                      });
+        auto theRecord = nameIndex.find(name);
 
-        if (theRecord == fileList.end()) {
+        if (theRecord == nameIndex.end()) {
             throw X::BadIndex("name, not matching any known filenames in this ROM");
         }
 
-        return *theRecord;
+        return fileList[theRecord->second];
+    }
+
+    Record ROM::recordContainingVAddress(size_t addr) const {
+        if (addr > 0xFFFF'FFFF) {
+            throw X::BadIndex("virtual address, past 32 bits");
+        }
+
+        // find the last file starting at or before the address; if anything
+        // contains it, that one does.
+        auto after = std::upper_bound(rangeIndex.begin(), rangeIndex.end(), addr,
+                                      [](size_t a, const std::pair<uint32_t, size_t> & b) {
+                                          return a < b.first;
+                                      });
+
+        if (after != rangeIndex.begin()) {
+            const Record & r = fileList[std::prev(after)->second];
+
+            if (addr < r.vend) {
+                return r;
+            }
+        }
+
+        throw X::BadIndex("virtual address, not inside any file");
     }
 
     File ROM::fileAtNum(size_t idx, bool autodecomp) const {
-        Record r = recordAtNum(idx);
-        return cachedAccess(r, autodecomp);
+        return cachedAccess(recordAtNum(idx), autodecomp);
     }
 
     File ROM::fileAtVAddress(size_t addr, bool autodecomp) const {
@@ -221,49 +501,49 @@ namespace ROM {
     }
 
     File ROM::cachedAccess(const Record & r, bool autodecomp) const {
-        if (fcache.count(r.vstart) == 0) {
-            // yes, we have to do some caching now
-            std::vector<uint8_t> nd;
+        // the file as it is in the ROM is just a view of the ROM's data, so
+        // there's nothing worth caching there.
+        File raw;
 
-            std::copy(rawData.begin() + r.pstart,
-                      rawData.begin() + r.pstart + r.psize(),
-                      std::back_inserter(nd));
-
-            fcache[r.vstart] = File(nd, r);
-        }
+        if (r.isMissing()) {
+            raw = File(std::shared_ptr<const uint8_t>(rawData, rawData->data()), 0, r);
+        } else {
+            if (r.pstart > rawData->size() || r.psize() > rawData->size() - r.pstart) {
+                throw X::BadROM("A file's listed location goes past the end of the ROM.");
+            }
 
-        if (autodecomp && decfcache.count(r.vstart) == 0) {
-            // decompression will be a no-op if it's not compressed, so we don't
-            // have to specialize on compression status.
-            decfcache[r.vstart] = fcache[r.vstart].decompress();
+            raw = File(std::shared_ptr<const uint8_t>(rawData, rawData->data() + r.pstart),
+                       r.psize(), r);
         }
 
-        if (autodecomp) {
-            return decfcache[r.vstart];
+        if (!autodecomp || !r.isCompressed()) {
+            return raw;
         }
 
-        return fcache[r.vstart];
+        return *decfcache.get(r.vstart, [&]() { return raw.decompress(); });
     }
 
-    size_t ROM::size() const { return rawData.size(); }
+    size_t ROM::size() const { return rawData->size(); }
 
     std::string ROM::get_rname() const {
         // lazy way to read until null byte
-        return std::string(reinterpret_cast<const char *>(rawData.data()) + 0x20);
+        return std::string(reinterpret_cast<const char *>(rawData->data()) + 0x20);
     }
 
     std::string ROM::get_rcode() const {
-        return std::string(rawData.begin() + 0x3B, rawData.begin() + 0x3F);
+        return std::string(rawData->data() + 0x3B, rawData->data() + 0x3F);
     }
 
-    std::vector<uint8_t> ROM::getData() const { return rawData; }
+    std::vector<uint8_t> ROM::getData() const {
+        return std::vector<uint8_t>(rawData->data(), rawData->data() + rawData->size());
+    }
 
     void ROM::bootstrapCompTime(size_t strat) {
         // to find the compile timestamp, we first store the known area into the
         // string, since it'll be a little easier to comb through a string in this
         // case.
 
-        std::string compileString = std::string(reinterpret_cast<char *>(rawData.data()) + strat, 0x30);
+        std::string compileString = std::string(reinterpret_cast<const char *>(rawData->data()) + strat, 0x30);
 
         // now to find the first null, after the username@hostname part
         size_t after_atpart = compileString.find_first_of('\0');
@@ -281,35 +561,17 @@ namespace ROM {
 
         // and finally, set the compile string to just the timestamp (we do it this
         // way to avoid any trailing nulls in the known area)
-        compileString = std::string(reinterpret_cast<char *>(rawData.data()) + strat + after_nulls);
+        compileString = std::string(reinterpret_cast<const char *>(rawData->data()) + strat + after_nulls);
 
         // now that that's done, we go ahead and figure out the correct version enum to set
-        if (compileString == "98-10-21 04:56:31") {
-            rver = Config::Version::OOT_NTSC_1_0;
-        } else if (compileString == "98-10-26 10:58:45") {
-            rver = Config::Version::OOT_NTSC_1_1;
-        } else if (compileString == "98-11-12 18:17:03") {
-            rver = Config::Version::OOT_NTSC_1_2;
-        } else if (compileString == "98-11-10 14:32:22") {
-            rver = Config::Version::OOT_PAL_1_0;
-        } else if (compileString == "98-11-18 17:36:49") {
-            rver = Config::Version::OOT_PAL_1_1;
-        } else if (compileString == "03-02-21 00:16:31") {
-            rver = Config::Version::OOT_MQ_DEBUG;
-        } else if (compileString == "00-03-31 02:22:11") {
-            rver = Config::Version::MM_JP_1_0;
-        } else if (compileString == "00-04-04 09:34:16") {
-            rver = Config::Version::MM_JP_1_1;
-        } else if (compileString == "00-07-31 17:04:16") {
-            rver = Config::Version::MM_US;
-        } else if (compileString == "00-09-25 11:16:53") {
-            rver = Config::Version::MM_EU_1_0;
-        } else if (compileString == "00-09-29 09:29:41") {
-            rver = Config::Version::MM_EU_1_1;
-        } else if (compileString == "00-09-29 09:29:05") {
-            rver = Config::Version::MM_DEBUG;
-        } else {
-            rver = Config::Version::UNKNOWN;
+        rver = Config::Version::UNKNOWN;
+
+        for (int v = static_cast<int>(Config::Version::OOT_NTSC_1_0);
+             v <= static_cast<int>(Config::Version::MM_DEBUG); v++) {
+            if (compileString == Config::compileTime(static_cast<Config::Version>(v))) {
+                rver = static_cast<Config::Version>(v);
+                break;
+            }
         }
 
         ctree = getConfigTree(rver);
@@ -348,7 +610,7 @@ namespace ROM {
     ROM::CRCPair ROM::getCRC() const {
         CRCPair cpair;
 
-        auto riter = rawData.begin() + 0x10;
+        auto riter = rawData->data() + 0x10;
 
         cpair.first  = be_u32(riter); riter += 4;
         cpair.second = be_u32(riter);
@@ -357,57 +619,132 @@ namespace ROM {
     }
 
     ROM::CRCPair ROM::calcCRC() const {
-        // yes, it overflows, but we want to chop it off to 32-bits anyway,
-        // which will happen for us. The 'u' suffixes are so we use standardized
-        // unsigned overflow, instead of accidentally hoping UB signed overflow
-        // will magically do the right thing.
-        uint32_t seed = 0x5D588B65u * 0x91u + 1u;
+        std::call_once(crcDone, [&]() {
+            crcResult = calcCRCOf(rawData->data());
+        });
+
+        return crcResult;
+    }
 
-        // we've got six registers to use in this calculation
-        std::array<uint32_t, 6> reg; reg.fill(seed);
+    const std::vector<uint64_t> & ROM::rawFileHashes() const {
+        std::call_once(hashesDone, [&]() {
+            std::vector<uint64_t> hashes(fileList.size());
 
-        // the data that gets verified by the algorithm; anything past this
-        // point is free for modification.
-        std::vector<uint8_t> chkthis;
-        std::copy(rawData.begin() + 0x1000, rawData.begin() + 0x101000,
-                  std::back_inserter(chkthis));
+            Parallel::forEachIndex(fileList.size(), [&](size_t idx) {
+                const Record & r = fileList[idx];
 
-        std::vector<uint8_t> extra;
-        std::copy(rawData.begin() + 0x750, rawData.begin() + 0x850,
-                  std::back_inserter(extra));
+                if (r.isMissing() || r.pstart > rawData->size() || r.psize() > rawData->size() - r.pstart) {
+                    hashes[idx] = hash64(nullptr, 0);
+                } else {
+                    hashes[idx] = hash64(rawData->data() + r.pstart, r.psize());
+                }
+            });
+
+            fileHashes = std::move(hashes);
+        });
+
+        return fileHashes;
+    }
 
-        auto iter = chkthis.begin();
+    ROM::CRCPair ROM::calcCRCOf(const uint8_t * rdata) {
+        return CRCState(rdata).result();
+    }
 
-        while (iter < chkthis.end()) {
-            uint32_t i = be_u32(iter);
+    void ROM::setCacheBudget(size_t bytes) {
+        decfcache.setBudget(bytes);
+    }
 
-            if (reg[0] + i < reg[0]) { // if this would overflow
-                reg[1]++;
+    FileCache::Stats ROM::cacheStats() const {
+        return decfcache.stats();
+    }
+
+    std::vector<uint8_t> ROM::decompressedImage() const {
+        // first figure out how big the image has to be, which is however far
+        // the furthest file goes, rounded up to a power of two like real
+        // cartridge sizes.
+        size_t needed = std::max<size_t>(rawData->size(), 0x101000); // at least enough for the CRC to cover
+
+        for (auto & i : fileList) {
+            if (!i.isMissing()) {
+                needed = std::max(needed, static_cast<size_t>(i.vend));
             }
+        }
 
-            uint32_t val = i & 0x1F;
-            val = (i << val) | (i >> (32 - val));
+        size_t imgsize = 1;
 
-            reg[0] += i;
-            reg[2] ^= i;
-            reg[3] += val;
+        while (imgsize < needed) {
+            imgsize <<= 1;
+        }
 
-            reg[4] ^= (reg[4] < i)
-                    ? (reg[0] ^ i)
-                    : val; 
+        // the TOC has to be found before anything else, since the build
+        // string just before it gets carried over along with it
+        auto tocrec = std::find_if(fileList.begin(), fileList.end(),
+                                   [&](const Record & a) {
+                                       return a.pstart == tocOffset;
+                                   });
 
-            size_t exidx = std::distance(chkthis.begin(), iter) % extra.size();
-            reg[5] += i ^ be_u32(extra.begin() + exidx);
+        if (tocrec == fileList.end()) {
+            throw X::BadROM("Didn't find the Table of Contents in its own list, which may indicate a problem.");
+        }
 
-            iter += 4;
+        if (tocOffset < 0x30 || tocrec->vstart < 0x30 || tocrec->vstart + fileList.size() * 16 > imgsize) {
+            throw X::BadROM("The table of contents doesn't fit where its record puts it.");
         }
 
-        // now to assimilate the six values into just two.
-        CRCPair cpair;
+        // everything not written below stays zero, like in the images other
+        // tools make. Only the header and boot code, and the build string
+        // just before the TOC, aren't covered by any file, so those get
+        // copied over first.
+        std::vector<uint8_t> img(imgsize, 0);
 
-        cpair.first  = reg[0] ^ reg[1] ^ reg[2];
-        cpair.second = reg[3] ^ reg[4] ^ reg[5];
+        std::copy(rawData->data(), rawData->data() + std::min<size_t>(rawData->size(), 0x1000), img.begin());
+        std::copy(rawData->data() + tocOffset - 0x30, rawData->data() + tocOffset,
+                  img.begin() + tocrec->vstart - 0x30);
 
-        return cpair;
+        // every file lands in its own part of the image, so all the files can
+        // be handled at once without stepping on each other.
+        Parallel::forEachIndex(fileList.size(), [&](size_t idx) {
+            const Record & r = fileList[idx];
+
+            if (r.isMissing() || r.vsize() == 0) {
+                return;
+            }
+
+            if (r.pstart > rawData->size() || r.psize() > rawData->size() - r.pstart) {
+                throw X::BadROM("A file's listed location goes past the end of the ROM.");
+            }
+
+            const uint8_t * src = rawData->data() + r.pstart;
+
+            if (r.isCompressed()) {
+                if (yaz0_decompressed_size(src, r.psize()) != r.vsize()) {
+                    throw X::Yaz0::Decompress("A file decompressed to a different size than its record says.");
+                }
+
+                yaz0_decompress_into(src, r.psize(), img.data() + r.vstart, r.vsize());
+            } else {
+                std::copy(src, src + r.vsize(), img.begin() + r.vstart);
+            }
+        });
+
+        // now the TOC, which sits at its virtual address like everything else
+        auto tocpos = img.begin() + tocrec->vstart;
+
+        for (auto & i : fileList) {
+            be_write_u32(tocpos,      i.vstart);
+            be_write_u32(tocpos + 4,  i.vend);
+            be_write_u32(tocpos + 8,  i.isMissing() ? 0xFFFF'FFFF : i.vstart);
+            be_write_u32(tocpos + 12, i.isMissing() ? 0xFFFF'FFFF : 0);
+
+            tocpos += 16;
+        }
+
+        // and finally fix up the CRC for the new contents
+        CRCPair newcrc = calcCRCOf(img.data());
+
+        be_write_u32(img.begin() + 0x10, newcrc.first);
+        be_write_u32(img.begin() + 0x14, newcrc.second);
+
+        return img;
     }
 }
\ No newline at end of file
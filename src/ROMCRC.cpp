@@ -0,0 +1,157 @@
+/** \file ROMCRC.cpp
+ *
+ *  \brief Implements the ROM CRC calculation.
+ *
+ *  Thanks to Zoinkity for the Python implementation from which this
+ *  implementation was originally adapted.
+ *
+ */
+
+#include "ROMCRC.hpp"
+#include "endian.hpp"
+
+#include <algorithm>
+
+namespace ROM {
+    const size_t CRCState::START;
+    const size_t CRCState::END;
+    const size_t CRCState::CHUNK_WORDS;
+    const size_t CRCState::CHUNK_SIZE;
+    const size_t CRCState::EXTRA_START;
+
+    namespace {
+        // yes, it overflows, but we want to chop it off to 32-bits anyway,
+        // which will happen for us. The 'u' suffixes are so we use
+        // standardized unsigned overflow, instead of accidentally hoping UB
+        // signed overflow will magically do the right thing.
+        const uint32_t SEED = 0x5D588B65u * 0x91u + 1u;
+    }
+
+    template<bool Parts>
+    void CRCState::runChunk(const uint8_t * words, Chunk & ch, uint32_t & reg0, uint32_t & r4) const {
+        uint64_t csum = 0;
+        uint32_t cxors = 0, crots = 0, cextras = 0;
+
+        for (size_t w = 0; w < CHUNK_WORDS; w++) {
+            uint32_t i = be_u32(words + w * 4);
+
+            // the "& 31" keeps a rotation by 0 from shifting by 32, which
+            // wouldn't be defined; it comes out the same as on the real thing.
+            uint32_t rot = i & 0x1F;
+            uint32_t val = (i << rot) | (i >> ((32 - rot) & 0x1F));
+
+            reg0 += i;
+
+            r4 ^= (r4 < i) ? (reg0 ^ i) : val;
+
+            if (Parts) {
+                csum += i;
+                cxors ^= i;
+                crots += val;
+                cextras += i ^ extra[w];
+            }
+        }
+
+        if (Parts) {
+            ch.sum = csum;
+            ch.xors = cxors;
+            ch.rots = crots;
+            ch.extras = cextras;
+        }
+    }
+
+    void CRCState::recalc(const uint8_t * rdata) {
+        for (size_t w = 0; w < CHUNK_WORDS; w++) {
+            extra[w] = be_u32(rdata + EXTRA_START + w * 4);
+        }
+
+        chunks.resize((END - START) / CHUNK_SIZE);
+
+        sum = SEED;
+        xors = rots = reg4 = extras = SEED;
+
+        uint32_t reg0 = SEED;
+
+        for (size_t c = 0; c < chunks.size(); c++) {
+            Chunk & ch = chunks[c];
+
+            ch.reg0In = reg0;
+            ch.reg4In = reg4;
+
+            runChunk<true>(rdata + START + c * CHUNK_SIZE, ch, reg0, reg4);
+
+            sum += ch.sum;
+            xors ^= ch.xors;
+            rots += ch.rots;
+            extras += ch.extras;
+        }
+    }
+
+    CRCState::CRCState(const uint8_t * rdata) {
+        recalc(rdata);
+    }
+
+    void CRCState::update(const uint8_t * rdata, size_t start, size_t end) {
+        // every word is mixed with the extra data, so changing that changes
+        // everything
+        if (start < EXTRA_START + CHUNK_SIZE && end > EXTRA_START) {
+            recalc(rdata);
+            return;
+        }
+
+        start = std::max(start, START);
+        end = std::min(end, END);
+
+        if (start >= end) {
+            return;
+        }
+
+        size_t firstc = (start - START) / CHUNK_SIZE;
+        size_t lastc = (end - START + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+        uint32_t reg0 = chunks[firstc].reg0In;
+        uint32_t r4 = chunks[firstc].reg4In;
+
+        // redo the edited chunks' parts, swapping them into the totals
+        for (size_t c = firstc; c < lastc; c++) {
+            Chunk & ch = chunks[c];
+            Chunk old = ch;
+
+            ch.reg0In = reg0;
+            ch.reg4In = r4;
+
+            runChunk<true>(rdata + START + c * CHUNK_SIZE, ch, reg0, r4);
+
+            sum += ch.sum - old.sum;
+            xors ^= ch.xors ^ old.xors;
+            rots += ch.rots - old.rots;
+            extras += ch.extras - old.extras;
+        }
+
+        // then carry the order-dependent register on, until it's back on its
+        // old track
+        for (size_t c = lastc; c < chunks.size(); c++) {
+            Chunk & ch = chunks[c];
+
+            if (ch.reg0In == reg0 && ch.reg4In == r4) {
+                return;
+            }
+
+            ch.reg0In = reg0;
+            ch.reg4In = r4;
+
+            runChunk<false>(rdata + START + c * CHUNK_SIZE, ch, reg0, r4);
+        }
+
+        reg4 = r4;
+    }
+
+    std::pair<uint32_t, uint32_t> CRCState::result() const {
+        // the first register is the low half of the sum, and the second
+        // counts how many times that overflowed.
+        uint32_t reg0 = static_cast<uint32_t>(sum);
+        uint32_t reg1 = SEED + static_cast<uint32_t>(sum >> 32);
+
+        return std::make_pair(reg0 ^ reg1 ^ xors, rots ^ reg4 ^ extras);
+    }
+}
\ No newline at end of file
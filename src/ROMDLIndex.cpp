@@ -0,0 +1,177 @@
+/** \file ROMDLIndex.cpp
+ *
+ *  \brief Implements the ROM-wide index of display lists.
+ *
+ */
+
+#include "ROMDLIndex.hpp"
+#include "ROMIndexCache.hpp"
+#include "Exceptions.hpp"
+#include "hash.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <numeric>
+
+namespace ROM {
+    namespace {
+        bool startsWith(const std::string & str, const std::string & start) {
+            return str.compare(0, start.size(), start) == 0;
+        }
+
+        bool endsWith(const std::string & str, const std::string & end) {
+            return str.size() >= end.size() && str.compare(str.size() - end.size(), end.size(), end) == 0;
+        }
+
+        DLEntry makeEntry(size_t file, size_t offset, const RCP::DisplayList & dl) {
+            std::array<uint32_t, RCP::Command::NUM_KINDS> counts{};
+
+            for (auto & i : dl) {
+                counts[static_cast<size_t>(i.kind)]++;
+            }
+
+            DLEntry res;
+
+            res.file = file;
+            res.offset = offset;
+            res.length = dl.size();
+
+            for (size_t k = 0; k < counts.size(); k++) {
+                if (counts[k] != 0) {
+                    res.histogram.push_back(KindCount{static_cast<RCP::Command::Kind>(k), counts[k]});
+                }
+            }
+
+            return res;
+        }
+
+        bool entryBefore(const DLEntry & a, const DLEntry & b) {
+            return a.file != b.file ? a.file < b.file : a.offset < b.offset;
+        }
+    }
+
+    ModelFile modelFileKind(const std::string & fname) {
+        if (startsWith(fname, "object_") || (startsWith(fname, "gameplay_") && endsWith(fname, "_keep"))) {
+            return ModelFile::OBJECT;
+        }
+
+        // checked before scenes, since MM's rooms start with Z2_ too
+        if (fname.find("_room_") != std::string::npos) {
+            return ModelFile::ROOM;
+        }
+
+        if (endsWith(fname, "_scene") || startsWith(fname, "Z2_")) {
+            return ModelFile::SCENE;
+        }
+
+        return ModelFile::NONE;
+    }
+
+    std::pair<std::vector<DLEntry>::const_iterator, std::vector<DLEntry>::const_iterator>
+    DLIndex::inFile(size_t file) const {
+        DLEntry key;
+        key.file = file;
+
+        return std::equal_range(lists.begin(), lists.end(), key, [](const DLEntry & a, const DLEntry & b) {
+            return a.file < b.file;
+        });
+    }
+
+    std::vector<size_t> modelFiles(const ROM & rom) {
+        std::vector<size_t> res;
+
+        for (size_t i = 0; i < rom.numFiles(); i++) {
+            const Record & r = rom.recordAtNum(i);
+
+            if (!r.isMissing() && r.vsize() != 0 && modelFileKind(r.fname) != ModelFile::NONE) {
+                res.push_back(i);
+            }
+        }
+
+        return res;
+    }
+
+    uint64_t dlSourceHash(const ROM & rom, const std::vector<size_t> & files) {
+        const std::vector<uint64_t> & hashes = rom.rawFileHashes();
+
+        std::vector<uint64_t> parts;
+        parts.reserve(files.size() * 2);
+
+        for (auto & i : files) {
+            parts.push_back(i);
+            parts.push_back(hashes.at(i));
+        }
+
+        return hash64(reinterpret_cast<const uint8_t *>(parts.data()), parts.size() * sizeof(uint64_t));
+    }
+
+    DLIndex scanDLs(const ROM & rom, const std::vector<size_t> & files) {
+        DLIndex res;
+
+        res.sourceHash = dlSourceHash(rom, files);
+        res.files = files;
+
+        // a few scenes are many times the size of the average object, so they
+        // go first; started last, they'd leave every other core waiting
+        std::vector<size_t> order(files.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return rom.recordAtNum(files[a]).vsize() > rom.recordAtNum(files[b]).vsize();
+        });
+
+        std::vector<std::vector<DLEntry>> found(files.size());
+        std::vector<char> bad(files.size(), false);
+
+        Parallel::forEachIndex(order.size(), [&](size_t n) {
+            size_t which = order[n];
+
+            try {
+                // not through the file cache, which would only end up holding
+                // whichever files happened to be scanned last
+                File rf = rom.fileAtNum(files[which], false).decompress();
+
+                for (auto & dl : RCP::getDLs(rf.begin(), rf.end())) {
+                    found[which].push_back(makeEntry(files[which], dl.first, dl.second));
+                }
+            } catch (Exception &) {
+                bad[which] = true;
+            }
+        });
+
+        for (size_t i = 0; i < files.size(); i++) {
+            if (bad[i]) {
+                res.failed.push_back(files[i]);
+            }
+
+            std::move(found[i].begin(), found[i].end(), std::back_inserter(res.lists));
+        }
+
+        // already in order if the files were, but they needn't be
+        std::stable_sort(res.lists.begin(), res.lists.end(), entryBefore);
+
+        return res;
+    }
+
+    DLIndex modelDLIndex(const ROM & rom, const std::string & indexDir) {
+        std::vector<size_t> files = modelFiles(rom);
+
+        if (indexDir.empty()) {
+            return scanDLs(rom, files);
+        }
+
+        IndexCache cache(indexDir);
+        DLIndex res;
+
+        if (cache.loadDLs(rom.size(), rom.getCRC(), dlSourceHash(rom, files), res)) {
+            return res;
+        }
+
+        res = scanDLs(rom, files);
+        cache.saveDLs(rom.size(), rom.getCRC(), res);
+
+        return res;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,303 @@
+/** \file ROMDiff.cpp
+ *
+ *  \brief Implements ROM comparison.
+ *
+ */
+
+#include "ROMDiff.hpp"
+#include "hash.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <unordered_map>
+
+namespace ROM {
+    namespace {
+        /** \brief Returns the first position at or after \c from where two
+         *         buffers differ, or \c size if they don't.
+         */
+        size_t firstDifference(const uint8_t * a, const uint8_t * b, size_t from, size_t size) {
+            // skip equal stretches a block at a time; memcmp is far faster at
+            // finding out they're equal than going byte by byte.
+            const size_t BLOCK = 64;
+
+            while (size - from >= BLOCK && std::memcmp(a + from, b + from, BLOCK) == 0) {
+                from += BLOCK;
+            }
+
+            while (from < size && a[from] == b[from]) {
+                from++;
+            }
+
+            return from;
+        }
+
+        std::vector<ByteRange> diffBytes(const uint8_t * a, size_t asize, const uint8_t * b, size_t bsize) {
+            std::vector<ByteRange> res;
+
+            if (asize == bsize) {
+                size_t pos = firstDifference(a, b, 0, asize);
+
+                while (pos < asize) {
+                    size_t end = pos + 1;
+
+                    // keep going until we've seen MERGE_GAP equal bytes in a
+                    // row (or run out of file)
+                    for (size_t i = end; i < asize && i - end < MERGE_GAP; i++) {
+                        if (a[i] != b[i]) {
+                            end = i + 1;
+                        }
+                    }
+
+                    res.push_back(ByteRange{pos, end, pos, end});
+
+                    pos = firstDifference(a, b, end, asize);
+                }
+
+                return res;
+            }
+
+            // for files that changed size, just trim what's common to both
+            // ends; anything finer would need a real diff algorithm, and
+            // files getting bigger or smaller are usually rebuilt anyway.
+            size_t common = std::min(asize, bsize);
+
+            size_t prefix = firstDifference(a, b, 0, common);
+            size_t suffix = 0;
+
+            while (suffix < common - prefix && a[asize - suffix - 1] == b[bsize - suffix - 1]) {
+                suffix++;
+            }
+
+            res.push_back(ByteRange{prefix, asize - suffix, prefix, bsize - suffix});
+
+            return res;
+        }
+
+        std::string changeName(FileDiff::Change which) {
+            switch (which) {
+              case FileDiff::Change::SAME:
+                return "same";
+                break;
+
+              case FileDiff::Change::REPACKED:
+                return "repacked";
+                break;
+
+              case FileDiff::Change::CHANGED:
+                return "changed";
+                break;
+
+              case FileDiff::Change::ADDED:
+                return "added";
+                break;
+
+              case FileDiff::Change::REMOVED:
+                return "removed";
+                break;
+            }
+
+            return "";
+        }
+
+        void writeRecord(std::ostream & out, const Record & r) {
+            out << std::hex << std::uppercase << std::setfill('0')
+                << std::setw(8) << r.vstart << "-" << std::setw(8) << r.vend
+                << std::dec << "  " << (r.fname.empty() ? "(unnamed)" : r.fname);
+        }
+
+        void writeRange(std::ostream & out, size_t start, size_t end) {
+            out << std::hex << std::uppercase << std::setfill('0')
+                << "0x" << std::setw(6) << start << "-0x" << std::setw(6) << end
+                << std::dec << " (" << end - start << " bytes)";
+        }
+    }
+
+    uint64_t fileContentHash(const File & rf) {
+        File dec = rf.decompress();
+        return hash64(dec.data(), dec.size());
+    }
+
+    std::vector<uint64_t> fileContentHashes(const ROM & rom) {
+        std::vector<uint64_t> res(rom.numFiles());
+
+        Parallel::forEachIndex(rom.numFiles(), [&](size_t idx) {
+            res[idx] = fileContentHash(rom.fileAtNum(idx, false));
+        });
+
+        return res;
+    }
+
+    size_t ROMDiff::count(FileDiff::Change which) const {
+        return std::count_if(files.begin(), files.end(), [&](const FileDiff & fd) { return fd.change == which; });
+    }
+
+    ROMDiff diffROMs(const ROM & older, const ROM & newer) {
+        ROMDiff res;
+
+        // index the new ROM's files the same way ROM does itself, the first
+        // file with a given address or name winning.
+        std::unordered_map<uint32_t, size_t> newByAddr;
+        std::unordered_map<std::string, size_t> newByName;
+
+        for (size_t i = 0; i < newer.numFiles(); i++) {
+            const Record & r = newer.recordAtNum(i);
+
+            if (r.vsize() == 0) {
+                continue;
+            }
+
+            newByAddr.emplace(r.vstart, i);
+
+            if (!r.fname.empty()) {
+                newByName.emplace(r.fname, i);
+            }
+        }
+
+        const std::vector<uint64_t> & oldHashes = older.rawFileHashes();
+        const std::vector<uint64_t> & newHashes = newer.rawFileHashes();
+
+        std::vector<bool> newUsed(newer.numFiles(), false);
+
+        // (old index, new index, index into res.files) of pairs that need a
+        // closer look
+        struct Pending {
+            size_t oldIdx;
+            size_t newIdx;
+            size_t diffIdx;
+        };
+
+        std::vector<Pending> pending;
+
+        for (size_t i = 0; i < older.numFiles(); i++) {
+            FileDiff fd = FileDiff();
+            fd.oldRec = older.recordAtNum(i);
+
+            if (fd.oldRec.vsize() == 0) {
+                continue;
+            }
+
+            // by address if we can, by name if not
+            size_t j = newer.numFiles();
+
+            auto byAddr = newByAddr.find(fd.oldRec.vstart);
+
+            if (byAddr != newByAddr.end() && !newUsed[byAddr->second]) {
+                j = byAddr->second;
+            } else if (!fd.oldRec.fname.empty()) {
+                auto byName = newByName.find(fd.oldRec.fname);
+
+                if (byName != newByName.end() && !newUsed[byName->second]) {
+                    j = byName->second;
+                }
+            }
+
+            if (j == newer.numFiles()) {
+                fd.change = FileDiff::Change::REMOVED;
+                res.files.push_back(fd);
+                continue;
+            }
+
+            newUsed[j] = true;
+            fd.newRec = newer.recordAtNum(j);
+
+            if (oldHashes[i] == newHashes[j]) {
+                fd.change = FileDiff::Change::SAME;
+            } else {
+                pending.push_back(Pending{i, j, res.files.size()});
+            }
+
+            res.files.push_back(fd);
+        }
+
+        for (size_t i = 0; i < newer.numFiles(); i++) {
+            FileDiff fd = FileDiff();
+            fd.newRec = newer.recordAtNum(i);
+
+            if (fd.newRec.vsize() == 0 || newUsed[i]) {
+                continue;
+            }
+
+            fd.change = FileDiff::Change::ADDED;
+            res.files.push_back(fd);
+        }
+
+        // now the files stored differently, which is where all the real work
+        // is; they're independent of each other, so do them all at once.
+        Parallel::forEachIndex(pending.size(), [&](size_t idx) {
+            const Pending & p = pending[idx];
+            FileDiff & fd = res.files[p.diffIdx];
+
+            File a = older.fileAtNum(p.oldIdx, false).decompress();
+            File b = newer.fileAtNum(p.newIdx, false).decompress();
+
+            if (a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin())) {
+                fd.change = FileDiff::Change::REPACKED;
+                return;
+            }
+
+            fd.change = FileDiff::Change::CHANGED;
+            fd.oldSize = a.size();
+            fd.newSize = b.size();
+            fd.ranges = diffBytes(a.data(), a.size(), b.data(), b.size());
+        });
+
+        return res;
+    }
+
+    void writeDiffReport(std::ostream & out, const ROMDiff & diff, size_t maxRanges) {
+        out << diff.count(FileDiff::Change::SAME) << " same, "
+            << diff.count(FileDiff::Change::REPACKED) << " repacked, "
+            << diff.count(FileDiff::Change::CHANGED) << " changed, "
+            << diff.count(FileDiff::Change::ADDED) << " added, "
+            << diff.count(FileDiff::Change::REMOVED) << " removed\n\n";
+
+        for (auto & fd : diff.files) {
+            if (fd.change == FileDiff::Change::SAME) {
+                continue;
+            }
+
+            out << std::left << std::setfill(' ') << std::setw(9) << changeName(fd.change) << std::right;
+
+            writeRecord(out, fd.change == FileDiff::Change::ADDED ? fd.newRec : fd.oldRec);
+
+            if (fd.change == FileDiff::Change::REPACKED || fd.change == FileDiff::Change::CHANGED) {
+                if (fd.newRec.vstart != fd.oldRec.vstart || fd.newRec.fname != fd.oldRec.fname) {
+                    out << "  -> ";
+                    writeRecord(out, fd.newRec);
+                }
+            }
+
+            out << "\n";
+
+            if (fd.change != FileDiff::Change::CHANGED) {
+                continue;
+            }
+
+            if (fd.oldSize != fd.newSize) {
+                out << "    size " << fd.oldSize << " -> " << fd.newSize << " bytes\n";
+            }
+
+            for (size_t i = 0; i < fd.ranges.size() && i < maxRanges; i++) {
+                const ByteRange & br = fd.ranges[i];
+
+                out << "    old ";
+                writeRange(out, br.oldStart, br.oldEnd);
+
+                if (br.newStart != br.oldStart || br.newEnd != br.oldEnd) {
+                    out << "  new ";
+                    writeRange(out, br.newStart, br.newEnd);
+                }
+
+                out << "\n";
+            }
+
+            if (fd.ranges.size() > maxRanges) {
+                out << "    ... and " << fd.ranges.size() - maxRanges << " more\n";
+            }
+        }
+    }
+}
\ No newline at end of file
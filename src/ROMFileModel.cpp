@@ -9,10 +9,45 @@
 
 #include <QIcon>
 
-ROMFileModel::ROMFileModel(ROM::ROM * ds) : data_src(ds) { }
+ROMFileModel::ROMFileModel(ROM::ROM * ds) : data_src(ds),
+                                             compressed_icon(QIcon::fromTheme("package-x-generic",
+                                                                              QIcon(":/icons/package-x-generic.svg"))),
+                                             missing_icon(":/icons/application-missing.svg") {
+    buildCache();
+}
+
+void ROMFileModel::buildCache() {
+    size_t count = data_src->numFiles();
+
+    names.clear();
+    vlocs.clear();
+    sizes.clear();
+    decorations.clear();
+
+    names.reserve(count);
+    vlocs.reserve(count);
+    sizes.reserve(count);
+    decorations.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        const ROM::Record & rec = data_src->recordAtNum(i);
+
+        names.push_back(QString::fromStdString(rec.fname));
+        vlocs.push_back(QString("0x%1").arg(QString("%1").arg(rec.vstart, 0, 16).toUpper()));
+        sizes.push_back(QString::fromStdString(sizeToIEC(rec.vsize())));
+
+        if (rec.isCompressed()) {
+            decorations.push_back(Decoration::COMPRESSED);
+        } else if (rec.isMissing()) {
+            decorations.push_back(Decoration::MISSING);
+        } else {
+            decorations.push_back(Decoration::NONE);
+        }
+    }
+}
 
 int ROMFileModel::rowCount(const QModelIndex & /*parent*/) const {
-    return data_src->numFiles();
+    return names.size();
 }
 
 int ROMFileModel::columnCount(const QModelIndex & /*parent*/) const {
@@ -27,28 +62,37 @@ QVariant ROMFileModel::data(const QModelIndex & index, int role) const {
         return QVariant();
     }
 
+    size_t row = index.row();
+
     if (role == Qt::DisplayRole) {
         switch (index.column()) {
           case 0:
-            return data_src->recordAtNum(index.row()).fname.c_str();
+            return names[row];
             break;
 
           case 1:
-            return QString("0x%1").arg(QString("%1").arg(data_src->recordAtNum(index.row()).vstart, 0, 16).toUpper());
+            return vlocs[row];
             break;
 
           case 2:
-            return QString(sizeToIEC(data_src->recordAtNum(index.row()).vsize()).c_str());
+            return sizes[row];
             break;
         }
 
         return "ERROR!";
     } else if (role == Qt::DecorationRole) {
         if (index.column() == 0) {
-            if (data_src->recordAtNum(index.row()).isCompressed()) {
-                return QIcon::fromTheme("package-x-generic", QIcon(":/icons/package-x-generic.svg"));
-            } else if (data_src->recordAtNum(index.row()).isMissing()) {
-                return QIcon(":/icons/application-missing.svg");
+            switch (decorations[row]) {
+              case Decoration::COMPRESSED:
+                return compressed_icon;
+                break;
+
+              case Decoration::MISSING:
+                return missing_icon;
+                break;
+
+              case Decoration::NONE:
+                break;
             }
         }
     }
@@ -87,5 +131,6 @@ void ROMFileModel::startResetting() {
 }
 
 void ROMFileModel::endResetting() {
+    buildCache();
     endResetModel();
 }
\ No newline at end of file
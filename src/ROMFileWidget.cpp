@@ -7,6 +7,7 @@
 #include "ROMFileWidget.hpp"
 
 #include "utility.hpp"
+#include "Exceptions.hpp"
 
 #include <QSettings>
 #include <QFileDialog>
@@ -37,6 +38,9 @@ ROMFileWidget::ROMFileWidget(QWidget * parent) : QWidget(parent) {
     empty_key = new QLabel(tr("Empty/Compressed?:"));
     empty_val = new QLabel;
 
+    head_key = new QLabel(tr("Starts With:"));
+    head_val = new QLabel;
+
     want_dec = new QCheckBox(tr("&Use decompressed"), this);
     want_dec->setToolTip(tr("If selected, uses the file decompressed if necessary. Otherwise, always use file as-is."));
 
@@ -50,6 +54,7 @@ ROMFileWidget::ROMFileWidget(QWidget * parent) : QWidget(parent) {
     vsize_val->setFont(monfont);
     ploc_val->setFont(monfont);
     psize_val->setFont(monfont);
+    head_val->setFont(monfont);
 
     want_dec->setEnabled(false);
     view_hex->setEnabled(false);
@@ -74,11 +79,14 @@ ROMFileWidget::ROMFileWidget(QWidget * parent) : QWidget(parent) {
     wlay->addWidget(empty_key, 6, 0, 1, 1, Qt::AlignRight);
     wlay->addWidget(empty_val, 6, 1, 1, 1, Qt::AlignLeft);
 
+    wlay->addWidget(head_key, 7, 0, 1, 1, Qt::AlignRight);
+    wlay->addWidget(head_val, 7, 1, 1, 1, Qt::AlignLeft);
+
 
-    wlay->addWidget(want_dec, 7, 0, 1, 2, Qt::AlignCenter);
-    wlay->addWidget(view_hex, 8, 0, 1, 2);
-    wlay->addWidget(save_file, 9, 0, 1, 2);
-    wlay->addWidget(see_obj, 10, 0, 1, 2);
+    wlay->addWidget(want_dec, 8, 0, 1, 2, Qt::AlignCenter);
+    wlay->addWidget(view_hex, 9, 0, 1, 2);
+    wlay->addWidget(save_file, 10, 0, 1, 2);
+    wlay->addWidget(see_obj, 11, 0, 1, 2);
 
     setLayout(wlay);
 
@@ -117,7 +125,7 @@ void ROMFileWidget::changeROM(ROM::ROM * nr) {
 }
 
 void ROMFileWidget::selectFile(const QModelIndex & cur, const QModelIndex & /*old*/) {
-    ROM::Record currec = the_rom->recordAtNum(cur.row());
+    const ROM::Record & currec = the_rom->recordAtNum(cur.row());
 
     ploc_val->setText(QString("0x%1").arg(
                           QString("%1").arg(currec.pstart, 8, 16, QChar('0')).toUpper()));
@@ -132,6 +140,28 @@ void ROMFileWidget::selectFile(const QModelIndex & cur, const QModelIndex & /*ol
     comp_val->setText(currec.isCompressed() ? tr("yes") : tr("no"));
 
     empty_val->setText(currec.isMissing() ? tr("yes") : tr("no"));
+
+    // show the first few bytes of the file's contents, which is usually
+    // enough to tell what it is. Only this much of a compressed file gets
+    // decompressed, so this stays quick even for huge files.
+    head_val->clear();
+
+    if (currec.isMissing()) {
+        return;
+    }
+
+    try {
+        std::vector<uint8_t> head = the_rom->fileAtNum(cur.row(), false).peek(8);
+        QString headstr;
+
+        for (auto & i : head) {
+            headstr += QString("%1 ").arg(i, 2, 16, QChar('0')).toUpper();
+        }
+
+        head_val->setText(headstr.trimmed());
+    } catch (Exception &) {
+        head_val->setText(tr("(unreadable)"));
+    }
 }
 
 void ROMFileWidget::saveFile() {
@@ -157,9 +187,9 @@ void ROMFileWidget::saveFile() {
 
     qs.setValue("main/last_save_zdata", saveto);
 
-    std::vector<uint8_t> thedata = the_rom->fileAtNum(filelist->currentIndex().row(), want_dec->isChecked()).getData();
+    ROM::File thefile = the_rom->fileAtNum(filelist->currentIndex().row(), want_dec->isChecked());
 
-    writeto.write(reinterpret_cast<char *>(thedata.data()), thedata.size());
+    writeto.write(reinterpret_cast<const char *>(thefile.data()), thefile.size());
 
     if (!writeto) {
         QMessageBox::warning(parentWidget(), tr("Possible Error in Saving"),
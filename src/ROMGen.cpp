@@ -0,0 +1,317 @@
+/** \file ROMGen.cpp
+ *
+ *  \brief Implements the synthetic ROM generator.
+ *
+ */
+
+#include "ROMGen.hpp"
+#include "ROMCRC.hpp"
+#include "byteswap.hpp"
+#include "endian.hpp"
+#include "Exceptions.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+
+namespace ROM {
+    namespace {
+        /** \brief Where boot starts, right after makerom
+         */
+        const size_t BOOT_START = 0x1060;
+
+        enum class Kind {
+            PLAIN,
+            COMPRESSED,
+            MISSING,
+        };
+
+        /** \brief Makes the contents of one file.
+         *
+         *  This mixes runs of zeros, short display lists, low-entropy
+         *  "texture" bytes and plain noise, which compresses about as well as
+         *  real game data does. Each file gets its own generator, seeded from
+         *  the image's seed and the file's index, so files can be made in any
+         *  order (or all at once) and still come out the same.
+         *
+         */
+        std::vector<uint8_t> fileContents(uint32_t seed, size_t idx, size_t size) {
+            std::mt19937 rng(seed ^ static_cast<uint32_t>(idx * 0x9E3779B9u));
+
+            std::vector<uint8_t> res;
+            res.reserve(size + 0x800);
+
+            while (res.size() < size) {
+                size_t chunk = 64 + rng() % 2048;
+
+                switch (rng() % 4) {
+                  case 0:
+                    res.insert(res.end(), chunk, 0);
+                    break;
+
+                  case 1: {
+                    // matrices, calls and syncs, ending in a G_ENDDL, where
+                    // the search for display lists will find them
+                    static const uint8_t heads[3][4] = {
+                        {0xDA, 0x38, 0x00, 0x03},
+                        {0xDE, 0x00, 0x00, 0x00},
+                        {0xE7, 0x00, 0x00, 0x00},
+                    };
+
+                    res.resize((res.size() + 7) & ~size_t(7));
+
+                    for (size_t i = 8; i < chunk; i += 8) {
+                        const uint8_t * head = heads[rng() % 3];
+                        uint8_t op[8] = {head[0], head[1], head[2], head[3], 0x00, 0x00, 0x00, 0x00};
+
+                        if (op[0] != 0xE7) {
+                            op[4] = 0x06;
+                            op[6] = rng() % 4;
+                            op[7] = (rng() % 16) * 8;
+                        }
+
+                        res.insert(res.end(), op, op + 8);
+                    }
+
+                    const uint8_t end[8] = {0xDF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+                    res.insert(res.end(), end, end + 8);
+                    break;
+                  }
+
+                  case 2:
+                    for (size_t i = 0; i < chunk; i++) {
+                        res.push_back(0x40 + rng() % 8);
+                    }
+                    break;
+
+                  case 3:
+                    for (size_t i = 0; i < chunk / 4; i++) {
+                        res.push_back(rng());
+                    }
+                    break;
+                }
+            }
+
+            res.resize(size);
+
+            return res;
+        }
+
+        std::string gameCode(Config::Version ver) {
+            std::string res = Config::getGame(ver) == Config::Game::Majora ? "NZS" : "CZL";
+
+            switch (Config::getRegion(ver)) {
+              case Config::Region::JP:
+                return res + "J";
+                break;
+
+              case Config::Region::PAL:
+              case Config::Region::EU:
+                return res + "P";
+                break;
+
+              default:
+                return res + "E";
+                break;
+            }
+        }
+
+        void writeRecord(std::vector<uint8_t>::iterator at, const Record & r) {
+            be_write_u32(at,      r.vstart);
+            be_write_u32(at + 4,  r.vend);
+            be_write_u32(at + 8,  r.pstart);
+            be_write_u32(at + 12, r.pend);
+        }
+
+        Record makeRecord(size_t vstart, size_t vend, size_t pstart, size_t pend) {
+            Record res;
+
+            res.vstart = vstart;
+            res.vend = vend;
+            res.pstart = pstart;
+            res.pend = pend;
+
+            return res;
+        }
+    }
+
+    Generated generate(const GenOptions & opts) {
+        if (opts.version == Config::Version::UNKNOWN) {
+            throw X::ROM::GenError("need a version to imitate");
+        }
+
+        if (opts.minFileSize == 0 || opts.minFileSize > opts.maxFileSize) {
+            throw X::ROM::GenError("bad range of file sizes");
+        }
+
+        if (opts.compressed < 0 || opts.missing < 0 || opts.compressed + opts.missing > 1) {
+            throw X::ROM::GenError("compressed and missing fractions must be between 0 and 1, together too");
+        }
+
+        size_t tocAt = opts.tocOffset != 0 ? opts.tocOffset : Config::tocOffset(opts.version);
+
+        if (tocAt % 16 != 0 || tocAt < BOOT_START + 0x30) {
+            throw X::ROM::GenError("the TOC has to be 16-byte aligned, and after the start of boot");
+        }
+
+        // decide on every file first, so the contents can be made in any order
+        std::mt19937 rng(opts.seed);
+        std::uniform_int_distribution<size_t> sizeDist(opts.minFileSize, opts.maxFileSize);
+        std::uniform_real_distribution<double> kindDist(0, 1);
+
+        std::vector<size_t> sizes(opts.files);
+        std::vector<Kind> kinds(opts.files);
+
+        for (size_t i = 0; i < opts.files; i++) {
+            sizes[i] = (sizeDist(rng) + 0xF) & ~size_t(0xF);
+
+            double k = kindDist(rng);
+
+            kinds[i] = k < opts.missing ? Kind::MISSING
+                     : k < opts.missing + opts.compressed ? Kind::COMPRESSED
+                     : Kind::PLAIN;
+        }
+
+        std::vector<std::vector<uint8_t>> stored(opts.files);
+
+        Parallel::forEachIndex(opts.files, [&](size_t idx) {
+            if (kinds[idx] == Kind::MISSING) {
+                return;
+            }
+
+            std::vector<uint8_t> plain = fileContents(opts.seed, idx, sizes[idx]);
+
+            if (kinds[idx] == Kind::COMPRESSED) {
+                stored[idx] = yaz0_compress(plain, opts.level);
+            } else {
+                stored[idx] = std::move(plain);
+            }
+        });
+
+        // now lay it all out
+        Generated res;
+
+        const size_t tocSize = (opts.files + 4) * 16;
+
+        res.records.push_back(makeRecord(0, BOOT_START, 0, 0));
+        res.records.push_back(makeRecord(BOOT_START, tocAt, BOOT_START, 0));
+        res.records.push_back(makeRecord(tocAt, tocAt + tocSize, tocAt, 0));
+
+        size_t vaddr = tocAt + tocSize;
+        size_t paddr = vaddr;
+
+        for (size_t i = 0; i < opts.files; i++) {
+            switch (kinds[i]) {
+              case Kind::MISSING:
+                res.records.push_back(makeRecord(vaddr, vaddr + sizes[i], 0xFFFF'FFFF, 0xFFFF'FFFF));
+                break;
+
+              case Kind::PLAIN:
+                res.records.push_back(makeRecord(vaddr, vaddr + sizes[i], paddr, 0));
+                paddr += sizes[i];
+                break;
+
+              case Kind::COMPRESSED: {
+                size_t csize = (stored[i].size() + 0xF) & ~size_t(0xF);
+
+                res.records.push_back(makeRecord(vaddr, vaddr + sizes[i], paddr, paddr + csize));
+                paddr += csize;
+                break;
+              }
+            }
+
+            vaddr += sizes[i];
+
+            // 0xFFFFFFFF marks missing files, so stay below it
+            if (vaddr >= 0xFFFF'FFFF || paddr >= 0xFFFF'FFFF) {
+                throw X::ROM::GenError("the files don't fit in 32-bit addresses");
+            }
+        }
+
+        res.records.push_back(Record());
+
+        size_t imageSize = 1;
+
+        while (imageSize < std::max({paddr, opts.minSize, size_t(CRCState::END)})) {
+            imageSize *= 2;
+        }
+
+        res.data.resize(imageSize);
+
+        // the header
+        be_write_u32(res.data.begin(),       0x80371240);
+        be_write_u32(res.data.begin() + 0x4, 0x0000000F);
+        be_write_u32(res.data.begin() + 0x8, 0x80000400);
+        be_write_u32(res.data.begin() + 0xC, 0x00001449);
+
+        std::string title = Config::getGame(opts.version) == Config::Game::Majora ? "ZELDA MAJORA'S MASK" : "THE LEGEND OF ZELDA";
+        title.resize(20, ' ');
+        std::copy(title.begin(), title.end(), res.data.begin() + 0x20);
+
+        std::string code = gameCode(opts.version);
+        std::copy(code.begin(), code.end(), res.data.begin() + 0x3B);
+
+        // boot gets filled with something, up to the build string and
+        // timestamp at its end
+        std::vector<uint8_t> boot = fileContents(opts.seed, SIZE_MAX, tocAt - 0x30 - BOOT_START);
+        std::copy(boot.begin(), boot.end(), res.data.begin() + BOOT_START);
+
+        const std::string build = "zelda@srd44";
+        std::copy(build.begin(), build.end(), res.data.begin() + tocAt - 0x30);
+
+        std::string stamp = Config::compileTime(opts.version);
+        std::copy(stamp.begin(), stamp.end(), res.data.begin() + tocAt - 0x20);
+
+        for (size_t i = 0; i < res.records.size(); i++) {
+            writeRecord(res.data.begin() + tocAt + i * 16, res.records[i]);
+        }
+
+        for (size_t i = 0; i < opts.files; i++) {
+            if (kinds[i] == Kind::MISSING) {
+                continue;
+            }
+
+            std::copy(stored[i].begin(), stored[i].end(), res.data.begin() + res.records[i + 3].pstart);
+        }
+
+        std::pair<uint32_t, uint32_t> crc = CRCState(res.data.data()).result();
+
+        be_write_u32(res.data.begin() + 0x10, crc.first);
+        be_write_u32(res.data.begin() + 0x14, crc.second);
+
+        if (opts.order == ByteOrder::SWAPPED_16) {
+            byteswap16(res.data.data(), res.data.size());
+        } else if (opts.order == ByteOrder::SWAPPED_32) {
+            byteswap32(res.data.data(), res.data.size());
+        }
+
+        return res;
+    }
+
+    GenOptions manyFilesShape() {
+        GenOptions res;
+
+        res.files = 10000;
+        res.minFileSize = 0x100;
+        res.maxFileSize = 0x4000;
+        res.compressed = 0.5;
+        res.missing = 0.02;
+
+        return res;
+    }
+
+    GenOptions hugeImageShape() {
+        GenOptions res;
+
+        res.files = 1500;
+        res.minFileSize = 0x1000;
+        res.maxFileSize = 0x40000;
+        res.compressed = 0.25;
+        res.minSize = 256 * 1024 * 1024;
+
+        return res;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,423 @@
+/** \file ROMIndexCache.cpp
+ *
+ *  \brief Implements the on-disk cache of ROM indexes.
+ *
+ */
+
+#include "ROMIndexCache.hpp"
+#include "endian.hpp"
+#include "hash.hpp"
+
+#include <QString>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace ROM {
+    namespace {
+        const uint8_t MAGIC[8] = {'Z', '6', '4', 'F', 'E', 'I', 'D', 'X'};
+        const uint8_t DL_MAGIC[8] = {'Z', '6', '4', 'F', 'E', 'D', 'L', 'S'};
+
+        // everything in the file is big-endian, like the ROMs themselves
+
+        void put32(std::vector<uint8_t> & out, uint32_t val) {
+            out.resize(out.size() + 4);
+            be_write_u32(out.end() - 4, val);
+        }
+
+        void put64(std::vector<uint8_t> & out, uint64_t val) {
+            put32(out, val >> 32);
+            put32(out, val);
+        }
+
+        /** \brief Reads values out of a cache file, noting if it runs short
+         */
+        class Reader {
+          private:
+            const uint8_t * pnt;
+            const uint8_t * end;
+            bool good = true;
+
+            bool have(size_t count) {
+                if (static_cast<size_t>(end - pnt) < count) {
+                    good = false;
+                }
+
+                return good;
+            }
+
+          public:
+            Reader(const std::vector<uint8_t> & data) : pnt(data.data()), end(data.data() + data.size()) { }
+
+            uint32_t u32() {
+                if (!have(4)) {
+                    return 0;
+                }
+
+                uint32_t res = be_u32(pnt);
+                pnt += 4;
+
+                return res;
+            }
+
+            uint64_t u64() {
+                uint64_t hi = u32();
+                return (hi << 32) | u32();
+            }
+
+            std::string str(size_t count) {
+                if (!have(count)) {
+                    return "";
+                }
+
+                std::string res(pnt, pnt + count);
+                pnt += count;
+
+                return res;
+            }
+
+            bool ok() const { return good; }
+            bool atEnd() const { return pnt == end; }
+        };
+
+        std::vector<uint8_t> readAll(const std::string & path) {
+            std::ifstream infile(path, std::ios::binary);
+
+            if (!infile) {
+                return {};
+            }
+
+            return std::vector<uint8_t>((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+        }
+
+        /** \brief Writes a cache file under a temporary name, and then
+         *         renames it into place.
+         *
+         *  QSaveFile picks a temporary name no other writer has, so the GUI
+         *  and the command-line program can save the same entry at once
+         *  without writing over each other's half-done file.
+         */
+        void writeAll(const std::string & path, const std::vector<uint8_t> & data) {
+            QSaveFile outfile(QString::fromStdString(path));
+
+            if (!outfile.open(QIODevice::WriteOnly)) {
+                return;
+            }
+
+            if (outfile.write(reinterpret_cast<const char *>(data.data()), data.size())
+                != static_cast<qint64>(data.size())) {
+                outfile.cancelWriting();
+                return;
+            }
+
+            // this only fails if the file couldn't be written after all, and
+            // then the temporary file is cleaned up with nothing replaced
+            outfile.commit();
+        }
+
+        void putIndexes(std::vector<uint8_t> & out, const std::vector<size_t> & idxs) {
+            put32(out, idxs.size());
+
+            for (auto & i : idxs) {
+                put32(out, i);
+            }
+        }
+
+        bool getIndexes(Reader & rd, size_t maxCount, std::vector<size_t> & idxs) {
+            uint32_t count = rd.u32();
+
+            if (!rd.ok() || count > maxCount) {
+                return false;
+            }
+
+            idxs.resize(count);
+
+            for (auto & i : idxs) {
+                i = rd.u32();
+            }
+
+            return rd.ok();
+        }
+    }
+
+    size_t tocEnd(const std::vector<Record> & files, size_t tocOffset, size_t romSize) {
+        // the TOC lists itself, as bootstrapTOC() makes sure of
+        auto tocrec = std::find_if(files.begin(), files.end(), [&](const Record & r) {
+            return r.pstart == tocOffset;
+        });
+
+        // the build string sits just before the TOC, and the TOC holds at
+        // least its own record
+        if (tocOffset < 0x30 || tocOffset > romSize || romSize - tocOffset < 16) {
+            return 0;
+        }
+
+        if (tocrec == files.end() || tocrec->isMissing() || tocrec->isCompressed()
+            || tocrec->psize() > romSize - tocOffset) {
+            return 0;
+        }
+
+        return tocOffset + tocrec->psize();
+    }
+
+    uint64_t configStamp(Config::Version ver) {
+        std::string path = configFilePath(ver);
+
+        if (path == "") {
+            return 0;
+        }
+
+        QFileInfo info(QString::fromStdString(path));
+
+        uint64_t parts[2] = {
+            static_cast<uint64_t>(info.size()),
+            static_cast<uint64_t>(info.lastModified().toMSecsSinceEpoch()),
+        };
+
+        return hash64(reinterpret_cast<const uint8_t *>(parts), sizeof(parts),
+                      hash64(reinterpret_cast<const uint8_t *>(path.data()), path.size()));
+    }
+
+    std::string defaultIndexDir() {
+        QString idxpath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/romindex";
+
+        if (!QDir().mkpath(idxpath)) {
+            return "";
+        }
+
+        return idxpath.toStdString();
+    }
+
+    IndexCache::IndexCache(const std::string & dir) : cachedir(dir) { }
+
+    std::string IndexCache::pathFor(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC,
+                                    const char * ext) const {
+        char name[64];
+
+        std::snprintf(name, sizeof(name), "%08X%08X-%llX.%s", headerCRC.first, headerCRC.second,
+                      static_cast<unsigned long long>(romSize), ext);
+
+        return cachedir + "/" + name;
+    }
+
+    bool IndexCache::load(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC, CachedIndex & out) const {
+        std::vector<uint8_t> data = readAll(pathFor(romSize, headerCRC));
+
+        Reader rd(data);
+        CachedIndex res;
+
+        if (rd.str(sizeof(MAGIC)) != std::string(MAGIC, MAGIC + sizeof(MAGIC))
+            || rd.u32() != FORMAT_VERSION) {
+            return false;
+        }
+
+        res.romSize = rd.u64();
+        res.headHash = rd.u64();
+        res.headerCRC.first = rd.u32();
+        res.headerCRC.second = rd.u32();
+
+        if (!rd.ok() || res.romSize != romSize || res.headerCRC != headerCRC) {
+            return false;
+        }
+
+        uint32_t order = rd.u32();
+        uint32_t ver = rd.u32();
+
+        if (order > static_cast<uint32_t>(ByteOrder::SWAPPED_32)
+            || ver > static_cast<uint32_t>(Config::Version::MM_DEBUG)) {
+            return false;
+        }
+
+        res.origOrder = static_cast<ByteOrder>(order);
+        res.rver = static_cast<Config::Version>(ver);
+        res.configStamp = rd.u64();
+
+        if (!rd.ok() || res.configStamp != configStamp(res.rver)) {
+            return false;
+        }
+
+        res.tocOffset = rd.u64();
+
+        uint32_t count = rd.u32();
+
+        // each record takes at least 20 bytes, so a count that couldn't
+        // possibly fit is just a damaged file
+        if (!rd.ok() || count > data.size() / 20) {
+            return false;
+        }
+
+        res.fileList.resize(count);
+
+        for (size_t i = 0; i < count; i++) {
+            Record & r = res.fileList[i];
+
+            r.vstart = rd.u32();
+            r.vend   = rd.u32();
+            r.pstart = rd.u32();
+            r.pend   = rd.u32();
+
+            r.fname = rd.str(rd.u32());
+        }
+
+        if (!rd.ok() || !rd.atEnd()) {
+            return false;
+        }
+
+        out = std::move(res);
+
+        return true;
+    }
+
+    void IndexCache::save(const CachedIndex & idx) const {
+        std::vector<uint8_t> data(MAGIC, MAGIC + sizeof(MAGIC));
+
+        put32(data, FORMAT_VERSION);
+
+        put64(data, idx.romSize);
+        put64(data, idx.headHash);
+        put32(data, idx.headerCRC.first);
+        put32(data, idx.headerCRC.second);
+
+        put32(data, static_cast<uint32_t>(idx.origOrder));
+        put32(data, static_cast<uint32_t>(idx.rver));
+        put64(data, idx.configStamp);
+
+        put64(data, idx.tocOffset);
+
+        put32(data, idx.fileList.size());
+
+        for (size_t i = 0; i < idx.fileList.size(); i++) {
+            const Record & r = idx.fileList[i];
+
+            put32(data, r.vstart);
+            put32(data, r.vend);
+            put32(data, r.pstart);
+            put32(data, r.pend);
+
+            put32(data, r.fname.size());
+            data.insert(data.end(), r.fname.begin(), r.fname.end());
+        }
+
+        writeAll(pathFor(idx.romSize, idx.headerCRC), data);
+    }
+
+    bool IndexCache::loadDLs(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC, uint64_t sourceHash,
+                             DLIndex & out) const {
+        std::vector<uint8_t> data = readAll(pathFor(romSize, headerCRC, "dls"));
+
+        Reader rd(data);
+        DLIndex res;
+
+        if (rd.str(sizeof(DL_MAGIC)) != std::string(DL_MAGIC, DL_MAGIC + sizeof(DL_MAGIC))
+            || rd.u32() != DL_FORMAT_VERSION) {
+            return false;
+        }
+
+        uint64_t size = rd.u64();
+        std::pair<uint32_t, uint32_t> crc;
+        crc.first = rd.u32();
+        crc.second = rd.u32();
+        res.sourceHash = rd.u64();
+
+        if (!rd.ok() || size != romSize || crc != headerCRC || res.sourceHash != sourceHash) {
+            return false;
+        }
+
+        // as with records, counts too big to fit in the file mean it's damaged
+        if (!getIndexes(rd, data.size() / 4, res.files) || !getIndexes(rd, data.size() / 4, res.failed)) {
+            return false;
+        }
+
+        // everything else names one of the files scanned, and the index gets
+        // used to look those files up, so anything else means it's damaged
+        std::vector<size_t> scanned = res.files;
+        std::sort(scanned.begin(), scanned.end());
+
+        auto wasScanned = [&](size_t file) {
+            return std::binary_search(scanned.begin(), scanned.end(), file);
+        };
+
+        if (!std::all_of(res.failed.begin(), res.failed.end(), wasScanned)) {
+            return false;
+        }
+
+        uint32_t count = rd.u32();
+
+        if (!rd.ok() || count > data.size() / 16) {
+            return false;
+        }
+
+        res.lists.resize(count);
+
+        for (auto & dl : res.lists) {
+            dl.file = rd.u32();
+            dl.offset = rd.u32();
+            dl.length = rd.u32();
+
+            uint32_t kinds = rd.u32();
+
+            if (!rd.ok() || !wasScanned(dl.file) || kinds > RCP::Command::NUM_KINDS) {
+                return false;
+            }
+
+            dl.histogram.resize(kinds);
+
+            for (auto & kc : dl.histogram) {
+                uint32_t kind = rd.u32();
+
+                if (kind >= RCP::Command::NUM_KINDS) {
+                    return false;
+                }
+
+                kc.kind = static_cast<RCP::Command::Kind>(kind);
+                kc.count = rd.u32();
+            }
+        }
+
+        if (!rd.ok() || !rd.atEnd()) {
+            return false;
+        }
+
+        out = std::move(res);
+
+        return true;
+    }
+
+    void IndexCache::saveDLs(uint64_t romSize, std::pair<uint32_t, uint32_t> headerCRC, const DLIndex & idx) const {
+        std::vector<uint8_t> data(DL_MAGIC, DL_MAGIC + sizeof(DL_MAGIC));
+
+        put32(data, DL_FORMAT_VERSION);
+
+        put64(data, romSize);
+        put32(data, headerCRC.first);
+        put32(data, headerCRC.second);
+        put64(data, idx.sourceHash);
+
+        putIndexes(data, idx.files);
+        putIndexes(data, idx.failed);
+
+        put32(data, idx.lists.size());
+
+        for (auto & dl : idx.lists) {
+            put32(data, dl.file);
+            put32(data, dl.offset);
+            put32(data, dl.length);
+
+            put32(data, dl.histogram.size());
+
+            for (auto & kc : dl.histogram) {
+                put32(data, static_cast<uint32_t>(kc.kind));
+                put32(data, kc.count);
+            }
+        }
+
+        writeAll(pathFor(romSize, headerCRC, "dls"), data);
+    }
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "ROMInfoWidget.hpp"
 #include "utility.hpp"
+#include "Exceptions.hpp"
 
 #include <QSpacerItem>
 #include <QSettings>
@@ -29,6 +30,9 @@ ROMInfoWidget::ROMInfoWidget(QWidget * parent) : QWidget(parent) {
     savebs = new QPushButton(tr("No ROM Loaded"));
     savebs->setEnabled(false);
 
+    savedec = new QPushButton(tr("No ROM Loaded"));
+    savedec->setEnabled(false);
+
     viewtxt = new QPushButton(tr("No ROM Loaded"));
     viewtxt->setEnabled(false);
 
@@ -50,7 +54,8 @@ ROMInfoWidget::ROMInfoWidget(QWidget * parent) : QWidget(parent) {
     wlay->addItem(new QSpacerItem(0, 0, QSizePolicy::Minimum, QSizePolicy::Expanding), 4, 0, 1, 3);
 
     wlay->addWidget(savebs, 5, 0, 1, 3);
-    wlay->addWidget(viewtxt, 6, 0, 1, 3);
+    wlay->addWidget(savedec, 6, 0, 1, 3);
+    wlay->addWidget(viewtxt, 7, 0, 1, 3);
 
     setLayout(wlay);
 
@@ -59,11 +64,16 @@ ROMInfoWidget::ROMInfoWidget(QWidget * parent) : QWidget(parent) {
      ***************/
 
     connect(savebs, &QPushButton::clicked, this, &ROMInfoWidget::saveROM);
+    connect(savedec, &QPushButton::clicked, this, &ROMInfoWidget::saveDecompressed);
     connect(viewtxt, &QPushButton::clicked, this, &ROMInfoWidget::browseText);
     connect(&crcverify, &QFutureWatcher<bool>::finished, this, &ROMInfoWidget::checkedCRC);
 }
 
 void ROMInfoWidget::changeROM(ROM::ROM * nr) {
+    // the old ROM goes away once we're told of the new one, so any check of
+    // it has to be done first
+    crcverify.waitForFinished();
+
     the_rom = nr;
 
     if (the_rom->wasByteswapped()) {
@@ -74,6 +84,9 @@ void ROMInfoWidget::changeROM(ROM::ROM * nr) {
         savebs->setText(tr("Wasn't byteswapped"));
     }
 
+    savedec->setEnabled(true);
+    savedec->setText(tr("Save &decompressed ROM..."));
+
     viewtxt->setEnabled(true);
     viewtxt->setText(tr("View Game Text"));
 
@@ -94,8 +107,8 @@ void ROMInfoWidget::changeROM(ROM::ROM * nr) {
     // do this in a thread since there's no reason to block on CRC verification
     crcverify.setFuture(
         QtConcurrent::run(
-            [this](){
-                return the_rom->getCRC() == the_rom->calcCRC();
+            [nr](){
+                return nr->getCRC() == nr->calcCRC();
             }));
 }
 
@@ -142,6 +155,47 @@ void ROMInfoWidget::saveROM() {
     writeto.close();
 }
 
+void ROMInfoWidget::saveDecompressed() {
+    QSettings qs;
+
+    QString saveto = QFileDialog::getSaveFileName(this, tr("Save Decompressed ROM"),
+                                                  qs.value("main/last_save_decrom").toString(),
+                                                  tr("N64 ROM Files (*.z64);;Any Files (*)"));
+
+    if (saveto == "") {
+        return;
+    }
+
+    std::ofstream writeto(saveto.toStdString(), std::ios::binary);
+
+    if (!writeto) {
+        QMessageBox::critical(parentWidget(), tr("Error in Saving"),
+                              tr("Couldn't open file \"%1\" for writing!").arg(saveto));
+        return;
+    }
+
+    qs.setValue("main/last_save_decrom", saveto);
+
+    std::vector<uint8_t> thedata;
+
+    try {
+        thedata = the_rom->decompressedImage();
+    } catch (Exception & e) {
+        QMessageBox::critical(parentWidget(), tr("Error in Decompressing"),
+                              tr("Couldn't decompress the ROM: %1").arg(e.what().c_str()));
+        return;
+    }
+
+    writeto.write(reinterpret_cast<char *>(thedata.data()), thedata.size());
+
+    if (!writeto) {
+        QMessageBox::warning(parentWidget(), tr("Possible Error in Saving"),
+                             tr("Something went wrong in writing the file, the saved file may be incomplete."));
+    }
+
+    writeto.close();
+}
+
 void ROMInfoWidget::browseText() {
     wantTextWindow();
 }
\ No newline at end of file
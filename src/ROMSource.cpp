@@ -0,0 +1,73 @@
+/** \file ROMSource.cpp
+ *
+ *  \brief Implements the ROM data source.
+ *
+ */
+
+#include "ROMSource.hpp"
+#include "Exceptions.hpp"
+
+#include <QString>
+
+#include <algorithm>
+
+namespace ROM {
+    Source::Source(const std::string & fname) : backing(QString::fromStdString(fname)) {
+        if (!backing.open(QIODevice::ReadOnly)) {
+            throw X::ROM::OpenError(backing.errorString().toStdString());
+        }
+
+        if (backing.size() == 0) {
+            // nothing to map, and mapping zero bytes is an error besides
+            return;
+        }
+
+        mappedSize = backing.size();
+        mapped = backing.map(0, mappedSize);
+
+        if (mapped == nullptr) {
+            // can't map it, so do it the old-fashioned way
+            QByteArray junk = backing.readAll();
+
+            if (static_cast<size_t>(junk.size()) != mappedSize) {
+                throw X::ROM::OpenError(backing.errorString().toStdString());
+            }
+
+            owned.assign(junk.begin(), junk.end());
+            backing.close();
+        }
+    }
+
+    Source::Source(std::vector<uint8_t> rfile) : owned(std::move(rfile)) { }
+
+    Source::~Source() {
+        unmap();
+    }
+
+    void Source::unmap() {
+        if (mapped != nullptr) {
+            backing.unmap(const_cast<uint8_t *>(mapped));
+            mapped = nullptr;
+            backing.close();
+        }
+    }
+
+    const uint8_t * Source::data() const {
+        return mapped != nullptr ? mapped : owned.data();
+    }
+
+    size_t Source::size() const {
+        return mapped != nullptr ? mappedSize : owned.size();
+    }
+
+    bool Source::isMapped() const { return mapped != nullptr; }
+
+    uint8_t * Source::makePrivate() {
+        if (mapped != nullptr) {
+            owned.assign(mapped, mapped + mappedSize);
+            unmap();
+        }
+
+        return owned.data();
+    }
+}
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include "endian.hpp"
 
 #include <sstream>
+#include <iomanip>
 #include <algorithm>
 
 namespace TextAST {
@@ -209,18 +210,15 @@ namespace TextAST {
         MessageIndex text_ids;
 
         if (Config::getGame(therom.getVersion()) == Config::Game::Ocarina) {
-            std::vector<uint8_t> codefile;
             ROM::File cf = therom.fileAtName("code");
 
             if (cf.record().isCompressed()) {
                 cf = cf.decompress();
             }
 
-            codefile = cf.getData();
-
             size_t msgoff = std::stoul(therom.configKey({"codeData", "TextMsgTable"}), nullptr, 0);
 
-            auto iter = codefile.begin() + msgoff;
+            auto iter = cf.begin() + msgoff;
 
 
             if (Config::getRegion(therom.getVersion()) == Config::Region::NTSC) {
@@ -341,18 +339,15 @@ namespace TextAST {
             // we'll use special MsgInfo items saying as much
 
             // first get the list of notebook IDs
-            std::vector<uint8_t> codefile;
             ROM::File cf = therom.fileAtName("code");
 
             if (cf.record().isCompressed()) {
                 cf = cf.decompress();
             }
 
-            codefile = cf.getData();
-
             size_t nboff = std::stoul(therom.configKey({"codeData", "NotebookIDList"}), nullptr, 0);
 
-            auto nbiter = codefile.begin() + nboff;
+            auto nbiter = cf.begin() + nboff;
 
             std::vector<uint16_t> nbids;
 
@@ -367,7 +362,7 @@ namespace TextAST {
 
                 // the given files should never be compressed, for a
                 // well-behaved rom, so we'll assume they aren't.
-                std::vector<uint8_t> curfile = therom.fileAtName("nes_message_table").getData();
+                ROM::File curfile = therom.fileAtName("nes_message_table");
 
                 for (auto i = curfile.begin(); i != curfile.end(); i += 8) {
                     MsgInfo mi(be_u32(i + 4) & 0x00FFFFFF);
@@ -379,7 +374,7 @@ namespace TextAST {
                     text_ids[Config::Language::EN][be_u16(i)] = mi;
                 }
 
-                curfile = therom.fileAtName("ger_message_table").getData();
+                curfile = therom.fileAtName("ger_message_table");
 
                 for (auto i = curfile.begin(); i != curfile.end(); i += 8) {
                     MsgInfo mi(be_u32(i + 4) & 0x00FFFFFF);
@@ -391,7 +386,7 @@ namespace TextAST {
                     text_ids[Config::Language::DE][be_u16(i)] = mi;
                 }
 
-                curfile = therom.fileAtName("fra_message_table").getData();
+                curfile = therom.fileAtName("fra_message_table");
 
                 for (auto i = curfile.begin(); i != curfile.end(); i += 8) {
                     MsgInfo mi(be_u32(i + 4) & 0x00FFFFFF);
@@ -403,7 +398,7 @@ namespace TextAST {
                     text_ids[Config::Language::FR][be_u16(i)] = mi;
                 }
 
-                curfile = therom.fileAtName("esp_message_table").getData();
+                curfile = therom.fileAtName("esp_message_table");
 
                 for (auto i = curfile.begin(); i != curfile.end(); i += 8) {
                     MsgInfo mi(be_u32(i + 4) & 0x00FFFFFF);
@@ -417,7 +412,7 @@ namespace TextAST {
             } else {
                 size_t msgoff = std::stoul(therom.configKey({"codeData", "TextMsgTable"}), nullptr, 0);
 
-                auto iter = codefile.begin() + msgoff;
+                auto iter = cf.begin() + msgoff;
 
                 Config::Language whatlang;
 
@@ -446,6 +441,419 @@ namespace TextAST {
 
         return text_ids;
     }
+
+    std::string fragmentAsCode(Fragment frag) {
+        std::stringstream r;
+
+        switch (frag.getType()) {
+          case Type::Literal:
+            r << frag.getValue<std::string>();
+            break;
+
+          case Type::Color:
+            switch (frag.getValue<Color>()) {
+              case Color::White:
+                r << "\\color{white}";
+                break;
+
+              case Color::Red:
+                r << "\\color{red}";
+                break;
+
+              case Color::Green:
+                r << "\\color{green}";
+                break;
+
+              case Color::Blue:
+                r << "\\color{blue}";
+                break;
+
+              case Color::Cyan:
+                // Sadly, I Myst my chance to put a joke here.
+                r << "\\color{cyan}";
+                break;
+
+              case Color::Magenta:
+                r << "\\color{magenta}";
+                break;
+
+              case Color::Yellow:
+                r << "\\color{yellow}";
+                break;
+
+              case Color::Black:
+                r << "\\color{black}";
+                break;
+
+              case Color::Gray:
+                r << "\\color{gray}";
+                break;
+
+              case Color::Orange:
+                r << "\\color{orange}";
+                break;
+            }
+            break;
+
+          case Type::EndMessage:
+            r << "\\endMessage{}";
+            break;
+
+          case Type::NewBox:
+            r << "\\newBox{}";
+            break;
+
+          case Type::Multispace:
+            r << "\\spaces{" << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::Goto:
+            r << "\\goto{0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(4)
+              << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::InstantTextState:
+            r << (frag.getValue<uint32_t>() ? "\\instantTextOn" : "\\instantTextOff") << "{}";
+            break;
+
+          case Type::StayOpen:
+            r << "\\keepBoxOpen{}";
+            break;
+
+          case Type::UnknownTrigger:
+            r << "\\unknownTrigger{}";
+            break;
+
+          case Type::Delay:
+            r << "\\waitXFrames{" << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::WaitOnButton:
+            r << "\\waitForAnyButton{}";
+            break;
+
+          case Type::DelayThenFade:
+            r << "\\waitXFramesThenFade{" << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::PlayerName:
+            r << "\\playerName{}";
+            break;
+
+          case Type::StartOcarina:
+            r << "\\startOcarinaPlaying{}";
+            break;
+
+          case Type::FadeWaitStop:
+            r << "\\bailFadeAndWait{}";
+            break;
+
+          case Type::PlaySFX:
+            r << "\\sfx{0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(4)
+              << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::ShowIcon:
+            r << "\\icon{0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(2)
+              << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::TextSpeedAt:
+            r << "\\setTextSpeedTo{0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(2)
+              << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::ChangeMsgBG:
+            r << "\\setBackground{0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(6)
+              << frag.getValue<uint32_t>() << "}";
+            break;
+
+
+          case Type::MarathonTime:
+            r << "\\marathonTime{}";
+            break;
+
+          case Type::RaceTime:
+            r << "\\raceTime{}";
+            break;
+
+          case Type::NumPoints:
+            r << "\\numberOfPoints{}";
+            break;
+
+          case Type::NumGoldSkulls:
+            r << "\\numberOfGoldSkulltulas{}";
+            break;
+
+          case Type::NoSkipping:
+            r << "\\cantSkipNow{}";
+            break;
+
+          case Type::TwoChoices:
+            r << "\\askTwoChoices{}";
+            break;
+
+          case Type::ThreeChoices:
+            r << "\\askThreeChoices{}";
+            break;
+
+          case Type::FishWeight:
+            r << "\\fishWeight{}";
+            break;
+
+          case Type::Highscore:
+            r << "\\hiscore{0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(2)
+              << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::WorldTime:
+            r << "\\worldTime{}";
+            break;
+
+          case Type::Button:
+            switch (frag.getValue<Button>()) {
+              case Button::A:
+                r << "\\A{}";
+                break;
+
+              case Button::B:
+                r << "\\B{}";
+                break;
+
+              case Button::C:
+                r << "\\C{}";
+                break;
+
+              case Button::L:
+                r << "\\L{}";
+                break;
+
+              case Button::R:
+                r << "\\R{}";
+                break;
+
+              case Button::Z:
+                r << "\\Z{}";
+                break;
+
+              case Button::C_UP:
+                r << "\\C{up}";
+                break;
+
+              case Button::C_DOWN:
+                r << "\\C{down}";
+                break;
+
+              case Button::C_LEFT:
+                r << "\\C{left}";
+                break;
+
+              case Button::C_RIGHT:
+                r << "\\C{right}";
+                break;
+
+              case Button::ASTICK:
+                r << "\\AnalogStick{}";
+                break;
+
+              case Button::DPAD:
+                r << "\\Dpad{}";
+                break;
+            }
+            break;
+
+          case Type::SwampArchHits:
+            r << "\\archerySwampHitsNeeded{}";
+            break;
+
+          case Type::NumFairiesGot:
+            r << "\\fairiesGotInThisDungeon{}";
+            break;
+
+          case Type::CarriageReturn:
+            r << "\\x{0D}";
+            break;
+
+          case Type::NoSkipping_withSfx:
+            r << "\\CantSkipNow[SFX]{}";
+            break;
+
+          case Type::DelayThenPrint:
+            r << "\\waitXFramesThenPrint{" << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::StayAfter:
+            r << "\\lingerXFramesOnBox{" << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::DelayThenEndText:
+            r << "\\waitXFramesThenEndText{" << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::FailedSongX:
+            r << "\\failedSongIndicator{}";
+            break;
+
+          case Type::PostmanGameTime:
+            r << "\\showTimePostmanGame{}";
+            break;
+
+          case Type::TimeLeftInFight:
+            r << "\\timeLeftInSkullkidFight{}";
+            break;
+
+          case Type::DekuFlowerGameScore:
+            r << "\\dekuFlowerGameScore{}";
+            break;
+
+          case Type::ShootingGalleryScore:
+            r << "\\shootingGalleryScore{}";
+            break;
+
+          case Type::BankRupeePrompt:
+            r << "\\bankPromptRupees{}";
+            break;
+
+          case Type::ShowRupeesGiven:
+            r << "\\showRupeesGiven{}";
+            break;
+
+          case Type::ShowRupeesEarned:
+            r << "\\showRupeesEarned{}";
+            break;
+
+          case Type::TimeLeft:
+            r << "\\timeLeft{}";
+            break;
+
+          case Type::LotteryRupeePrompt:
+            r << "\\lotteryPromptRupees{}";
+            break;
+
+          case Type::BomberCodePrompt:
+            r << "\\bombersPromptCode{}";
+            break;
+
+          case Type::WaitOnItem:
+            r << "\\waitForAnyItem{}";
+            break;
+
+          case Type::SoaringDestination:
+            r << "\\songSoaringDest{}";
+            break;
+
+          case Type::LotteryGuessPrompt:
+            r << "\\lotteryPromptGuess{}";
+            break;
+
+          case Type::OceanSpiderMaskOrder:
+            r << "\\showOceanSpiderMaskOrder{}";
+            break;
+
+          case Type::FairiesLeftIn:
+            r << "\\fairiesLeftAt{";
+
+            switch (frag.getValue<uint32_t>()) {
+              case 1:
+                r << "Woodfall";
+                break;
+
+              case 2:
+                r << "Snowhead";
+                break;
+
+              case 3:
+                r << "Great Bay";
+                break;
+
+              case 4:
+                r << "Stone Tower";
+                break;
+
+              default:
+                r << "UNKNOWN!!! " << frag.getValue<uint32_t>();
+                break;
+            }
+
+            r << "}";
+            break;
+
+          case Type::SwampArchScore:
+            r << "\\archerySwampScore{}";
+            break;
+
+          case Type::ShowLotteryNumber:
+            r << "\\lotteryCorrectAnswer{}";
+            break;
+
+          case Type::ShowLotteryGuess:
+            r << "\\lotteryPlayerAnswer{}";
+            break;
+
+          case Type::MonetaryValue:
+            r << "\\showValueOfItem{}";
+            break;
+
+          case Type::ShowBomberCode:
+            r << "\\showBomberCode{}";
+            break;
+
+          case Type::EndConversation:
+            r << "\\endConversation{}";
+            break;
+
+          case Type::ShowMaskColor:
+            r << "\\showColorOfOceanSpiderMask{" << frag.getValue<uint32_t>() << "}";
+            break;
+
+          case Type::HoursLeft:
+            r << "\\hoursRemaining{}";
+            break;
+
+          case Type::TimeToMorning:
+            r << "\\timeUntilMorning{}";
+            break;
+
+          case Type::OctoArchHiscore:
+            r << "\\archeryOctoHiscore{}";
+            break;
+
+          case Type::BeanPrice:
+            r << "\\priceOfBean{}";
+            break;
+
+          case Type::EponaArchHiscore:
+            r << "\\archeryEponaHiscore{}";
+            break;
+
+          case Type::DekuFlowerGameDailyHiscore:
+            r << "\\dekuFlowerGameHiscoreOnDay{" << frag.getValue<uint32_t>() << "}";
+            break;
+        }
+
+        return r.str();
+    }
+
+    std::string messageAsCode(std::vector<Box> msg) {
+        std::stringstream result;
+
+        result << "\\begin{message}\n";
+
+        for (auto & i : msg) {
+            result << "\\begin{box}\n";
+            for (auto & j : i) {
+                for (auto & k : j) {
+                    result << fragmentAsCode(k);
+                }
+                result << "\n";
+            }
+            result << "\\end{box}\n";
+        }
+
+        result << "\\end{message}";
+
+        return result.str();
+    }
 }
 
 namespace X {
@@ -12,7 +12,7 @@
 
 #include <map>
 
-std::vector<TextAST::Box> readASCII_OoT(std::vector<uint8_t>::iterator & takethis) {
+std::vector<TextAST::Box> readASCII_OoT(const uint8_t * & takethis) {
     std::vector<TextAST::Box> the_list;
     bool cont = true;
 
@@ -286,7 +286,7 @@ std::vector<TextAST::Box> readASCII_OoT(std::vector<uint8_t>::iterator & takethi
 
 
 
-std::vector<TextAST::Box> readShiftJIS_OoT(std::vector<uint8_t>::iterator & takethis) {
+std::vector<TextAST::Box> readShiftJIS_OoT(const uint8_t * & takethis) {
     std::vector<TextAST::Box> the_list;
     bool cont = true;
 
@@ -639,7 +639,7 @@ std::vector<TextAST::Box> readShiftJIS_OoT(std::vector<uint8_t>::iterator & take
     return the_list;
 }
 
-std::vector<TextAST::Box> readASCII_MM(std::vector<uint8_t>::iterator & indata) {
+std::vector<TextAST::Box> readASCII_MM(const uint8_t * & indata) {
     std::vector<TextAST::Box> the_list;
     bool cont = true;
 
@@ -1053,7 +1053,7 @@ std::vector<TextAST::Box> readASCII_MM(std::vector<uint8_t>::iterator & indata)
     return the_list;
 }
 
-std::vector<TextAST::Box> readShiftJIS_MM(std::vector<uint8_t>::iterator & indata) {
+std::vector<TextAST::Box> readShiftJIS_MM(const uint8_t * & indata) {
     // note that MM Shift-JIS in particular seems to thrive on being a modified
     // Shift-JIS with a constant two-byte format (its space character is 0020
     // instead of 20, for example). However, we'll still assume normal,
@@ -1433,4 +1433,72 @@ std::vector<TextAST::Box> readShiftJIS_MM(std::vector<uint8_t>::iterator & indat
     }
 
     return the_list;
+}
+
+std::vector<TextAST::Box> readMessage(const ROM::ROM & rom, Config::Language lang, TextAST::MsgInfo & minfo) {
+    ROM::File msgfile;
+
+    switch (lang) {
+      case Config::Language::JP:
+        msgfile = rom.fileAtName("jpn_message_data_static");
+        break;
+
+      case Config::Language::EN:
+        msgfile = rom.fileAtName("nes_message_data_static");
+        break;
+
+      case Config::Language::DE:
+        msgfile = rom.fileAtName("ger_message_data_static");
+        break;
+
+      case Config::Language::FR:
+        msgfile = rom.fileAtName("fra_message_data_static");
+        break;
+
+      case Config::Language::ES:
+        msgfile = rom.fileAtName("esp_message_data_static");
+        break;
+    }
+
+    bool isOoT = Config::getGame(rom.getVersion()) == Config::Game::Ocarina;
+
+    // MM's messages start with the box kind and position, and then some more
+    // header bytes (how many depends on the region), before any text
+    size_t header = isOoT ? 0 : lang == Config::Language::JP ? 12 : 11;
+
+    if (minfo.address >= msgfile.size() || msgfile.size() - minfo.address <= header) {
+        throw X::BadIndex("message address, past the end of the message file");
+    }
+
+    auto readptr = msgfile.begin() + minfo.address;
+
+    if (isOoT) {
+        if (lang == Config::Language::JP) {
+            return readShiftJIS_OoT(readptr);
+        } else {
+            return readASCII_OoT(readptr);
+        }
+    }
+
+    if (minfo.kind == TextAST::BoxKind::MM_DEFER) {
+        minfo.kind = TextAST::MM_BoxKind(*readptr);
+    }
+
+    ++readptr;
+
+    if (minfo.where == TextAST::BoxYPos::MM_DEFER) {
+        minfo.where = TextAST::MM_BoxYPos(*readptr);
+    }
+
+    ++readptr;
+
+    // advancing the iterator past the header depends on the region,
+    // for some reason
+    if (lang == Config::Language::JP) {
+        readptr += 10;
+        return readShiftJIS_MM(readptr);
+    } else {
+        readptr += 9;
+        return readASCII_MM(readptr);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+/** \file bytesearch.cpp
+ *
+ *  \brief Implements the byte string search.
+ *
+ */
+
+#include "bytesearch.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Z64FE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+const uint8_t * findBytes(const uint8_t * hay, size_t haysize,
+                          const uint8_t * needle, size_t needlesize) {
+    const uint8_t * notfound = hay + haysize;
+
+    if (needlesize == 0) {
+        return hay;
+    }
+
+    if (needlesize > haysize) {
+        return notfound;
+    }
+
+    // every position a match could start at is below this
+    size_t last = haysize - needlesize + 1;
+    size_t i = 0;
+
+#ifdef Z64FE_SSE2
+    if (needlesize > 1) {
+        __m128i first = _mm_set1_epi8(static_cast<char>(needle[0]));
+        __m128i final = _mm_set1_epi8(static_cast<char>(needle[needlesize - 1]));
+
+        for (; i + 16 <= last; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(hay + i + needlesize - 1));
+
+            unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first),
+                                                            _mm_cmpeq_epi8(b, final)));
+
+            while (mask != 0) {
+                unsigned bit = 0;
+
+                while (!(mask & (1u << bit))) {
+                    bit++;
+                }
+
+                if (std::memcmp(hay + i + bit + 1, needle + 1, needlesize - 2) == 0) {
+                    return hay + i + bit;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+
+    // whatever's left, or everything without SSE2, goes to memchr for the
+    // first byte (which is vectorized in most C libraries anyway).
+    while (i < last) {
+        const void * cand = std::memchr(hay + i, needle[0], last - i);
+
+        if (cand == nullptr) {
+            break;
+        }
+
+        i = static_cast<const uint8_t *>(cand) - hay;
+
+        if (std::memcmp(hay + i, needle, needlesize) == 0) {
+            return hay + i;
+        }
+
+        i++;
+    }
+
+    return notfound;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+/** \file byteswap.cpp
+ *
+ *  \brief Implements the byteswapping functions.
+ *
+ */
+
+#include "byteswap.hpp"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Z64FE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// AVX2 can't be assumed, so with GCC and clang we compile those loops for it
+// separately and pick at runtime. Other compilers only get it if the whole
+// build targets AVX2 anyway.
+#if defined(__AVX2__)
+#define Z64FE_AVX2 1
+#define Z64FE_AVX2_TARGET
+#define Z64FE_HAS_AVX2() true
+#include <immintrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define Z64FE_AVX2 1
+#define Z64FE_AVX2_TARGET __attribute__((target("avx2")))
+#define Z64FE_HAS_AVX2() __builtin_cpu_supports("avx2")
+#include <immintrin.h>
+#endif
+
+namespace {
+    // the scalar loops handle whatever's left after the vector ones (or
+    // everything, without any); they go through memcpy so unaligned buffers
+    // are fine.
+
+    size_t swap16Scalar(uint8_t * data, size_t size) {
+        size_t i = 0;
+
+        for (; i + 2 <= size; i += 2) {
+            uint16_t v;
+            std::memcpy(&v, data + i, 2);
+            v = static_cast<uint16_t>((v << 8) | (v >> 8));
+            std::memcpy(data + i, &v, 2);
+        }
+
+        return i;
+    }
+
+    size_t swap32Scalar(uint8_t * data, size_t size) {
+        size_t i = 0;
+
+        for (; i + 4 <= size; i += 4) {
+            uint32_t v;
+            std::memcpy(&v, data + i, 4);
+            v = (v << 24) | ((v << 8) & 0x00FF0000) | ((v >> 8) & 0x0000FF00) | (v >> 24);
+            std::memcpy(data + i, &v, 4);
+        }
+
+        return i;
+    }
+
+#ifdef Z64FE_SSE2
+    size_t swap16SSE2(uint8_t * data, size_t size) {
+        size_t i = 0;
+
+        for (; i + 16 <= size; i += 16) {
+            __m128i * p = reinterpret_cast<__m128i *>(data + i);
+            __m128i v = _mm_loadu_si128(p);
+
+            _mm_storeu_si128(p, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+        }
+
+        return i;
+    }
+
+    size_t swap32SSE2(uint8_t * data, size_t size) {
+        size_t i = 0;
+
+        // SSE2 has no byte shuffle, so swap the bytes in each half-word, then
+        // the half-words in each word.
+        for (; i + 16 <= size; i += 16) {
+            __m128i * p = reinterpret_cast<__m128i *>(data + i);
+            __m128i v = _mm_loadu_si128(p);
+
+            v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            v = _mm_shufflelo_epi16(_mm_shufflehi_epi16(v, 0xB1), 0xB1);
+
+            _mm_storeu_si128(p, v);
+        }
+
+        return i;
+    }
+#endif
+
+#ifdef Z64FE_AVX2
+    Z64FE_AVX2_TARGET size_t shuffleAVX2(uint8_t * data, size_t size, __m256i order) {
+        size_t i = 0;
+
+        for (; i + 32 <= size; i += 32) {
+            __m256i * p = reinterpret_cast<__m256i *>(data + i);
+
+            _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), order));
+        }
+
+        return i;
+    }
+
+    Z64FE_AVX2_TARGET size_t swap16AVX2(uint8_t * data, size_t size) {
+        return shuffleAVX2(data, size, _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                                        1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+    }
+
+    Z64FE_AVX2_TARGET size_t swap32AVX2(uint8_t * data, size_t size) {
+        return shuffleAVX2(data, size, _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                                        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+    }
+#endif
+}
+
+void byteswap16(uint8_t * data, size_t size) {
+    size_t done = 0;
+
+#ifdef Z64FE_AVX2
+    if (Z64FE_HAS_AVX2()) {
+        done = swap16AVX2(data, size);
+    }
+#endif
+
+#ifdef Z64FE_SSE2
+    done += swap16SSE2(data + done, size - done);
+#endif
+
+    swap16Scalar(data + done, size - done);
+}
+
+void byteswap32(uint8_t * data, size_t size) {
+    size_t done = 0;
+
+#ifdef Z64FE_AVX2
+    if (Z64FE_HAS_AVX2()) {
+        done = swap32AVX2(data, size);
+    }
+#endif
+
+#ifdef Z64FE_SSE2
+    done += swap32SSE2(data + done, size - done);
+#endif
+
+    swap32Scalar(data + done, size - done);
+}
\ No newline at end of file
@@ -7,85 +7,559 @@
 #include "yaz0.hpp"
 #include "endian.hpp"
 #include "Exceptions.hpp"
+#include "Parallel.hpp"
 
-#include <string>
+#include <cstring>
 #include <iostream>
+#include <algorithm>
 
-std::vector<uint8_t> yaz0_decompress(std::vector<uint8_t> ciphertext) {
-    std::string magic(ciphertext.begin(), ciphertext.begin() + 4);
+namespace {
+    const size_t HEADER_SIZE = 16;
 
-    if (magic != "Yaz0" && magic != "Yaz1") {
+    // an opset byte and eight three-byte back-references
+    const size_t MAX_GROUP_IN  = 1 + 8 * 3;
+
+    // eight maximum-length back-references, plus room for the fast copies
+    // overshooting the end of one
+    const size_t MAX_GROUP_OUT = 8 * 0x111 + 16;
+
+    /** \brief Copies a back-reference in 16-byte chunks.
+     *
+     *  May write up to 15 bytes past the end of the copy, so the caller must
+     *  have that much room left (the extra bytes get overwritten by whatever
+     *  comes next anyway).
+     *
+     */
+    inline void copyBackFast(uint8_t * dst, size_t back, size_t len) {
+        const uint8_t * src = dst - back;
+        uint8_t * end = dst + len;
+
+        if (back == 1) {
+            std::memset(dst, *src, len);
+            return;
+        }
+
+        // for short distances, repeat the pattern into itself until it's far
+        // enough back for chunked copies; copying from further back by a
+        // multiple of the pattern's length gives the same bytes.
+        while (dst - src < 16 && dst < end) {
+            size_t dist = dst - src;
+
+            std::memcpy(dst, src, dist);
+            dst += dist;
+        }
+
+        for (; dst < end; dst += 16, src += 16) {
+            std::memcpy(dst, src, 16);
+        }
+    }
+}
+
+size_t yaz0_decompressed_size(const uint8_t * ciphertxt, size_t size) {
+    if (size < HEADER_SIZE) {
+        throw X::Yaz0::Decompress("File too small to be compressed.");
+    }
+
+    if (std::memcmp(ciphertxt, "Yaz0", 4) != 0 && std::memcmp(ciphertxt, "Yaz1", 4) != 0) {
         throw X::Yaz0::Decompress("Not actually a compressed file.");
     }
 
-    // we don't really need to use the size param, since we're using vectors,
-    // but it does make for a cooler-looking implementation if we have a
-    // pre-sized vector over using push_back.
+    return be_u32(ciphertxt + 4);
+}
+
+void yaz0_decompress_into(const uint8_t * ciphertxt, size_t csize, uint8_t * plaintxt, size_t psize) {
+    size_t dsize = yaz0_decompressed_size(ciphertxt, csize);
+
+    if (psize < dsize) {
+        throw X::Yaz0::Decompress("Output buffer too small for decompressed file.");
+    }
+
+    const uint8_t * cipher_R_pnt = ciphertxt + HEADER_SIZE; // last 8 bytes of header unused
+    const uint8_t * cipher_end   = ciphertxt + csize;
+    uint8_t * plain_W_pnt = plaintxt;
+    uint8_t * plain_end   = plaintxt + dsize;
 
-    uint32_t dsize = be_u32(ciphertext.begin() + 4);
+    while (cipher_R_pnt != cipher_end && plain_W_pnt != plain_end) {
+        // once we're far enough into the output that no back-reference can
+        // reach before its start, and far enough from the end of both
+        // buffers that a whole opset can't run past them, we can decode the
+        // next eight operations without checking anything.
+        if (static_cast<size_t>(plain_W_pnt - plaintxt) >= 0x1000
+            && static_cast<size_t>(cipher_end - cipher_R_pnt) >= MAX_GROUP_IN
+            && static_cast<size_t>(plain_end - plain_W_pnt) >= MAX_GROUP_OUT) {
+            uint8_t opset = *cipher_R_pnt++;
 
-    std::vector<uint8_t> plaintext(dsize, 0);
+            for (int i = 0; i < 8; i++, opset <<= 1) {
+                if (opset & 0x80) {
+                    *plain_W_pnt++ = *cipher_R_pnt++;
+                } else {
+                    size_t readcnt = cipher_R_pnt[0] >> 4;
+                    size_t backamt = (((cipher_R_pnt[0] & 0x0F) << 8) | cipher_R_pnt[1]) + 1;
+                    cipher_R_pnt += 2;
 
-    // index pointers, quite important
-    auto cipher_R_pnt = ciphertext.begin() + 16; // last 8 bytes of header unused
-    auto plain_R_pnt  = plaintext.begin();
-    auto plain_W_pnt  = plaintext.begin();
+                    if (readcnt == 0) {
+                        readcnt = *cipher_R_pnt++ + 0x10;
+                    }
+
+                    readcnt += 0x2;
+
+                    copyBackFast(plain_W_pnt, backamt, readcnt);
+                    plain_W_pnt += readcnt;
+                }
+            }
+
+            continue;
+        }
 
-    while (cipher_R_pnt != ciphertext.end() && plain_W_pnt != plaintext.end()) {
         uint8_t opset = *cipher_R_pnt++;
 
-        // the weird choice for comparison is because an unsigned int see 0 - 1
-        // == -1 as a positive number, of course, so the standard 0 <= i is
-        // useless.
-        for (uint8_t i = 7; i <= 7; i--) {
-            // each iteration, if we're now at the end of the cipher stream (or
-            // write buffer), we'll just stop; it's permissible (AFAIK) to not
-            // pad your data to use all of the last opset.
-            if (cipher_R_pnt == ciphertext.end() || plain_W_pnt == plaintext.end()) {
+        for (int i = 0; i < 8; i++, opset <<= 1) {
+            // if we're now at the end of the cipher stream (or write buffer),
+            // we'll just stop; it's permissible (AFAIK) to not pad your data
+            // to use all of the last opset.
+            if (cipher_R_pnt == cipher_end || plain_W_pnt == plain_end) {
                 break;
             }
 
-            if (opset & (1 << i)) { // bit on: copy byte
+            if (opset & 0x80) { // bit on: copy byte
                 *plain_W_pnt++ = *cipher_R_pnt++;
-            } else { // bit off: run data
-                // readcnt is 16-bit in the event that we get a size of
-                // e.g. 0xFF for it; then 0xFF + 0x12 = 0x111
-                uint16_t readcnt = (*cipher_R_pnt) >> 4;
-                uint16_t backamt = (*cipher_R_pnt++) & 0x0F;
-                backamt = (backamt << 8) | *cipher_R_pnt++;
-                backamt++; // plus 1 to stated back amount
-
-                if (readcnt == 0) {
-                    readcnt = *cipher_R_pnt++ + 0x10;
-                }
+                continue;
+            }
 
-                readcnt += 0x2;
+            // bit off: run data
+            if (cipher_end - cipher_R_pnt < 2
+                || ((cipher_R_pnt[0] >> 4) == 0 && cipher_end - cipher_R_pnt < 3)) {
+                throw X::Yaz0::Decompress("Compressed data ends in the middle of a back-reference.");
+            }
 
-                // now to set up the other read pointer
-                plain_R_pnt = plain_W_pnt - backamt;
+            size_t readcnt = cipher_R_pnt[0] >> 4;
+            size_t backamt = (((cipher_R_pnt[0] & 0x0F) << 8) | cipher_R_pnt[1]) + 1;
+            cipher_R_pnt += 2;
 
-                // and now to copy! (the line in this loop is the
-                // "cooler-looking implementation" mentioned earlier)
-                for (uint16_t i = 0; i < readcnt; i++) {
-                    *plain_W_pnt++ = *plain_R_pnt++;
-                }
+            if (readcnt == 0) {
+                readcnt = *cipher_R_pnt++ + 0x10;
+            }
+
+            readcnt += 0x2;
+
+            if (backamt > static_cast<size_t>(plain_W_pnt - plaintxt)) {
+                throw X::Yaz0::Decompress("Back-reference points before the start of the file.");
+            }
+
+            if (readcnt > static_cast<size_t>(plain_end - plain_W_pnt)) {
+                throw X::Yaz0::Decompress("Back-reference runs past the end of the file.");
+            }
+
+            const uint8_t * plain_R_pnt = plain_W_pnt - backamt;
+
+            for (size_t j = 0; j < readcnt; j++) {
+                *plain_W_pnt++ = *plain_R_pnt++;
             }
         }
     }
 
     // now to do a quick check in the event that the write buffer got filled out
     // before we read the whole cipher buffer
-    while (cipher_R_pnt != ciphertext.end()) {
-        if (*cipher_R_pnt != 0) {
-            std::cerr << "Warning: Not likely to be padding found after write buffer filled.\n";
-        }
-
-        cipher_R_pnt++;
+    if (std::any_of(cipher_R_pnt, cipher_end, [](uint8_t b) { return b != 0; })) {
+        std::cerr << "Warning: Not likely to be padding found after write buffer filled.\n";
     }
 
-    if (plain_W_pnt != plaintext.end()) {
+    if (plain_W_pnt != plain_end) {
         throw X::Yaz0::Decompress("Some kind of problem with decompressing, didn't fill up plaintext exactly.");
     }
+}
+
+std::vector<uint8_t> yaz0_decompress(const uint8_t * ciphertxt, size_t size) {
+    std::vector<uint8_t> plaintext(yaz0_decompressed_size(ciphertxt, size));
+
+    yaz0_decompress_into(ciphertxt, size, plaintext.data(), plaintext.size());
 
     return plaintext;
+}
+
+std::vector<uint8_t> yaz0_decompress(const std::vector<uint8_t> & ciphertxt) {
+    return yaz0_decompress(ciphertxt.data(), ciphertxt.size());
+}
+
+Yaz0Stream::Yaz0Stream(const uint8_t * ciphertxt, size_t size)
+    : cipher_R_pnt(ciphertxt + HEADER_SIZE), cipher_end(ciphertxt + size),
+      total(yaz0_decompressed_size(ciphertxt, size)) { }
+
+size_t Yaz0Stream::read(uint8_t * out, size_t count) {
+    size_t written = 0;
+
+    count = std::min(count, total - produced);
+
+    while (written < count) {
+        if (copyLeft > 0) {
+            // finish as much of the current back-reference as we can at once
+            size_t run = std::min(copyLeft, count - written);
+
+            for (size_t i = 0; i < run; i++) {
+                uint8_t b = history[(produced - copyBack) % history.size()];
+
+                history[produced++ % history.size()] = b;
+                out[written++] = b;
+            }
+
+            copyLeft -= run;
+            continue;
+        }
+
+        if (opsLeft == 0) {
+            if (cipher_R_pnt == cipher_end) {
+                throw X::Yaz0::Decompress("Compressed data ended before the whole file was decompressed.");
+            }
+
+            opset = *cipher_R_pnt++;
+            opsLeft = 8;
+        }
+
+        bool literal = opset & 0x80;
+
+        opset <<= 1;
+        opsLeft--;
+
+        if (literal) {
+            if (cipher_R_pnt == cipher_end) {
+                throw X::Yaz0::Decompress("Compressed data ended before the whole file was decompressed.");
+            }
+
+            history[produced++ % history.size()] = *cipher_R_pnt;
+            out[written++] = *cipher_R_pnt++;
+            continue;
+        }
+
+        if (cipher_end - cipher_R_pnt < 2
+            || ((cipher_R_pnt[0] >> 4) == 0 && cipher_end - cipher_R_pnt < 3)) {
+            throw X::Yaz0::Decompress("Compressed data ends in the middle of a back-reference.");
+        }
+
+        copyLeft = cipher_R_pnt[0] >> 4;
+        copyBack = (((cipher_R_pnt[0] & 0x0F) << 8) | cipher_R_pnt[1]) + 1;
+        cipher_R_pnt += 2;
+
+        if (copyLeft == 0) {
+            copyLeft = *cipher_R_pnt++ + 0x10;
+        }
+
+        copyLeft += 0x2;
+
+        if (copyBack > produced) {
+            throw X::Yaz0::Decompress("Back-reference points before the start of the file.");
+        }
+
+        if (copyLeft > total - produced) {
+            throw X::Yaz0::Decompress("Back-reference runs past the end of the file.");
+        }
+    }
+
+    return written;
+}
+
+size_t Yaz0Stream::size() const { return total; }
+
+size_t Yaz0Stream::position() const { return produced; }
+
+bool Yaz0Stream::done() const { return produced == total; }
+
+namespace {
+    const size_t WINDOW_SIZE = 0x1000;  // farthest back a match can reach
+    const size_t MIN_MATCH   = 0x3;
+    const size_t MAX_MATCH   = 0x111;   // 0xFF + 0x12
+    const size_t LONG_MATCH  = 0x12;    // shortest match needing a third byte
+
+    const size_t HASH_BITS   = 15;
+
+    struct Match {
+        size_t length = 0;
+        size_t distance = 0;
+    };
+
+    /** \brief Finds back-references using hash chains.
+     *
+     *  Every position is hashed on its next three bytes; \c head holds the
+     *  latest position for each hash, and \c prev links each position to the
+     *  previous one with the same hash. Since nothing further back than the
+     *  window can be used, \c prev only needs to be window-sized.
+     *
+     *  Positions are stored plus one, so that zero can mean "none".
+     *
+     */
+    class MatchFinder {
+      private:
+        const uint8_t * data;
+        size_t size;
+        size_t chainLimit;
+
+        std::vector<size_t> head;
+        std::vector<size_t> prev;
+
+        size_t inserted = 0; ///< everything before this is in the chains
+
+        size_t hashAt(size_t pos) const {
+            uint32_t key = (data[pos] << 16) | (data[pos + 1] << 8) | data[pos + 2];
+
+            return (key * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        void insertUpTo(size_t end) {
+            end = std::min(end, size - std::min(size, MIN_MATCH - 1));
+
+            for (; inserted < end; inserted++) {
+                size_t h = hashAt(inserted);
+
+                prev[inserted % WINDOW_SIZE] = head[h];
+                head[h] = inserted + 1;
+            }
+        }
+
+      public:
+        MatchFinder(const uint8_t * d, size_t s, size_t cl) : data(d), size(s), chainLimit(cl),
+                                                               head(1 << HASH_BITS, 0),
+                                                               prev(WINDOW_SIZE, 0) { }
+
+        /** \brief Finds the longest match for the data at \c pos.
+         *
+         *  Every position before \c pos is added to the chains first, so
+         *  positions must be asked about in increasing order.
+         *
+         */
+        Match longest(size_t pos) {
+            Match best;
+
+            insertUpTo(pos);
+
+            if (size - pos < MIN_MATCH) {
+                return best;
+            }
+
+            size_t maxlen = std::min(MAX_MATCH, size - pos);
+            size_t chains = chainLimit;
+            size_t cand = head[hashAt(pos)];
+
+            while (cand != 0 && pos - (cand - 1) <= WINDOW_SIZE && chains-- > 0) {
+                const uint8_t * here = data + pos;
+                const uint8_t * there = data + cand - 1;
+
+                // can only do better if it also matches at our current length
+                if (there[best.length] == here[best.length]) {
+                    size_t len = 0;
+
+                    while (len < maxlen && there[len] == here[len]) {
+                        len++;
+                    }
+
+                    if (len > best.length) {
+                        best.length = len;
+                        best.distance = pos - (cand - 1);
+
+                        if (len == maxlen) {
+                            break;
+                        }
+                    }
+                }
+
+                cand = prev[(cand - 1) % WINDOW_SIZE];
+            }
+
+            if (best.length < MIN_MATCH) {
+                best = Match();
+            }
+
+            return best;
+        }
+    };
+
+    /** \brief Writes out Yaz0 data, taking care of the opset bytes.
+     */
+    class Encoder {
+      private:
+        std::vector<uint8_t> out;
+        size_t opsetAt = 0;
+        uint8_t opsLeft = 0;
+
+        void nextOp(bool copy) {
+            if (opsLeft == 0) {
+                opsetAt = out.size();
+                out.push_back(0);
+                opsLeft = 8;
+            }
+
+            opsLeft--;
+
+            if (copy) {
+                out[opsetAt] |= 1 << opsLeft;
+            }
+        }
+
+      public:
+        Encoder(size_t dsize) {
+            // worst case is every byte copied, plus an opset per eight
+            out.reserve(16 + dsize + dsize / 8 + 1);
+
+            out.insert(out.end(), {'Y', 'a', 'z', '0'});
+            out.push_back(dsize >> 24);
+            out.push_back(dsize >> 16);
+            out.push_back(dsize >> 8);
+            out.push_back(dsize);
+            out.resize(16, 0);
+        }
+
+        void literal(uint8_t byte) {
+            nextOp(true);
+            out.push_back(byte);
+        }
+
+        void match(const Match & m) {
+            size_t back = m.distance - 1;
+
+            nextOp(false);
+
+            if (m.length < LONG_MATCH) {
+                out.push_back(((m.length - 2) << 4) | (back >> 8));
+                out.push_back(back & 0xFF);
+            } else {
+                out.push_back(back >> 8);
+                out.push_back(back & 0xFF);
+                out.push_back(m.length - LONG_MATCH);
+            }
+        }
+
+        std::vector<uint8_t> finish() { return std::move(out); }
+    };
+
+    // cost of each operation, in bits, counting its bit in the opset byte
+    size_t opCost(size_t length) {
+        return length < MIN_MATCH ? 9 : length < LONG_MATCH ? 17 : 25;
+    }
+
+    void compressGreedy(const uint8_t * plain, size_t size, Encoder & enc) {
+        MatchFinder finder(plain, size, 16);
+
+        for (size_t pos = 0; pos < size;) {
+            Match m = finder.longest(pos);
+
+            if (m.length == 0) {
+                enc.literal(plain[pos++]);
+            } else {
+                enc.match(m);
+                pos += m.length;
+            }
+        }
+    }
+
+    void compressLazy(const uint8_t * plain, size_t size, Encoder & enc) {
+        MatchFinder finder(plain, size, 128);
+
+        Match ahead;
+        bool haveAhead = false;
+
+        for (size_t pos = 0; pos < size;) {
+            Match m = haveAhead ? ahead : finder.longest(pos);
+            haveAhead = false;
+
+            if (m.length == 0) {
+                enc.literal(plain[pos++]);
+                continue;
+            }
+
+            // if waiting a byte gets us a longer match, take the literal now
+            // and let the next round use that match instead.
+            if (m.length < MAX_MATCH && pos + 1 < size) {
+                ahead = finder.longest(pos + 1);
+
+                if (ahead.length > m.length) {
+                    enc.literal(plain[pos++]);
+                    haveAhead = true;
+                    continue;
+                }
+            }
+
+            enc.match(m);
+            pos += m.length;
+        }
+    }
+
+    void compressOptimal(const uint8_t * plain, size_t size, Encoder & enc) {
+        MatchFinder finder(plain, size, WINDOW_SIZE);
+
+        // a match of some length at some distance is also a match of any
+        // shorter length there, so knowing the longest match at each position
+        // is enough to know every option we have.
+        std::vector<Match> found(size);
+
+        for (size_t pos = 0; pos < size; pos++) {
+            found[pos] = finder.longest(pos);
+        }
+
+        // cost[i] is the fewest bits needed to encode everything from i on,
+        // and step[i] the length of the operation at i getting there.
+        std::vector<size_t> cost(size + 1, 0);
+        std::vector<uint16_t> step(size, 1);
+
+        for (size_t pos = size; pos-- > 0;) {
+            cost[pos] = opCost(1) + cost[pos + 1];
+
+            for (size_t len = MIN_MATCH; len <= found[pos].length; len++) {
+                size_t c = opCost(len) + cost[pos + len];
+
+                if (c <= cost[pos]) {
+                    cost[pos] = c;
+                    step[pos] = len;
+                }
+            }
+        }
+
+        for (size_t pos = 0; pos < size;) {
+            if (step[pos] == 1) {
+                enc.literal(plain[pos++]);
+            } else {
+                Match m = found[pos];
+                m.length = step[pos];
+
+                enc.match(m);
+                pos += m.length;
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> yaz0_compress(const uint8_t * plaintxt, size_t size, Yaz0Level level) {
+    if (size > 0xFFFFFFFF) {
+        throw X::Yaz0::Compress("Data too large to fit in a Yaz0 file.");
+    }
+
+    Encoder enc(size);
+
+    switch (level) {
+      case Yaz0Level::FAST:
+        compressGreedy(plaintxt, size, enc);
+        break;
+
+      case Yaz0Level::NORMAL:
+        compressLazy(plaintxt, size, enc);
+        break;
+
+      case Yaz0Level::MAX:
+        compressOptimal(plaintxt, size, enc);
+        break;
+    }
+
+    return enc.finish();
+}
+
+std::vector<uint8_t> yaz0_compress(const std::vector<uint8_t> & plaintxt, Yaz0Level level) {
+    return yaz0_compress(plaintxt.data(), plaintxt.size(), level);
+}
+
+std::vector<std::vector<uint8_t>> yaz0_compress_all(const std::vector<std::vector<uint8_t>> & plaintxts,
+                                                    Yaz0Level level) {
+    std::vector<std::vector<uint8_t>> res(plaintxts.size());
+
+    Parallel::forEachIndex(plaintxts.size(), [&](size_t i) {
+        res[i] = yaz0_compress(plaintxts[i], level);
+    });
+
+    return res;
 }
\ No newline at end of file